@@ -0,0 +1,104 @@
+// Times the ways a setting can be looked up by name: the std::map the
+// settings used to live in, the SettingsTable hash index, and the
+// NameIndex ConfigItems keeps in front of it, the same header it uses.
+// No Godot needed, StringName is stood in for by an interned pointer
+// with a cached hash, which is all the index relies on.
+//
+//   g++ -std=c++17 -O2 -I../src config_lookup_bench.cpp ../src/config_table.cpp ../src/config_journal.cpp -o config_lookup_bench
+//   ./config_lookup_bench [settings] [lookups]
+
+#include "config_table.h"
+#include "name_index.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+// what a StringName boils down to: one shared copy, hashed once
+struct InternedName
+{
+    const std::string* text{};
+    uint32_t hash{};
+    bool operator==(const InternedName& other) const { return text == other.text; }
+};
+
+class NamePool
+{
+public:
+    InternedName intern(const std::string& text)
+    {
+        auto& stored = *names_.insert(text).first;
+        return InternedName{ &stored, static_cast<uint32_t>(std::hash<std::string>{}(text)) };
+    }
+
+private:
+    std::unordered_set<std::string> names_{};
+};
+
+template<typename F>
+double timeLookups(const char* label, const size_t lookups, F lookup)
+{
+    int64_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < lookups; i++) {
+        sum += lookup(i);
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    // the sum keeps the loop from being optimized away
+    std::printf("%-16s %8.2f ns/lookup  (checksum %lld)\n", label, elapsed / lookups, static_cast<long long>(sum));
+    return elapsed;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    size_t settingCount = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 500;
+    size_t lookups = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5000000;
+    if (settingCount == 0 || lookups == 0)
+        return 1;
+
+    // names shaped like the real ones, section/key
+    std::vector<std::string> names;
+    for (size_t i = 0; i < settingCount; i++) {
+        names.push_back("section_" + std::to_string(i % 17) + "/setting_name_" + std::to_string(i));
+    }
+
+    std::map<std::string, int64_t> byMap;
+    SettingsTable table;
+    NamePool pool;
+    NameIndex<InternedName> index;
+    std::vector<InternedName> interned;
+    for (size_t i = 0; i < names.size(); i++) {
+        byMap[names[i]] = static_cast<int64_t>(i);
+        auto slot = table.add(names[i], SettingsTable::T_INT);
+        table.setInt(slot, static_cast<int64_t>(i));
+        interned.push_back(pool.intern(names[i]));
+        index.remember(interned.back(), interned.back().hash, slot);
+    }
+
+    // the same random order for everyone
+    std::vector<uint32_t> order(lookups);
+    std::mt19937 random(1234);
+    for (auto& next : order) {
+        next = static_cast<uint32_t>(random() % settingCount);
+    }
+
+    std::printf("%zu settings, %zu lookups\n", settingCount, lookups);
+    timeLookups("std::map", lookups, [&](size_t i) {
+        return byMap.find(names[order[i]])->second;
+    });
+    timeLookups("SettingsTable", lookups, [&](size_t i) {
+        return table.getInt(table.find(names[order[i]]));
+    });
+    timeLookups("StringName", lookups, [&](size_t i) {
+        return table.getInt(index.find(interned[order[i]], interned[order[i]].hash));
+    });
+    return 0;
+}
@@ -6,5 +6,10 @@
 
 void ensureFolderExists(const String folder);
 
+// lets godot strings be used as keys in the std unordered containers
+struct StringHasher {
+    size_t operator()(const String& value) const { return static_cast<size_t>(value.hash()); }
+};
+
 #endif /// __SRG_COMMON_UTILITIES__
 
@@ -0,0 +1,141 @@
+#include "config_journal.h"
+#include <algorithm>
+
+void SettingsJournal::clear()
+{
+    // where things stand now is a fresh start, no older position reaches it
+    floorId_ = nextId_++;
+    records_.clear();
+    cursor_ = 0;
+    bytes_ = 0;
+}
+
+void SettingsJournal::setBudget(const size_t bytes)
+{
+    budget_ = bytes;
+    trim();
+}
+
+void SettingsJournal::record(const SettingsTable::slot_t slot, SettingsTable::Value&& old)
+{
+    // our own swaps come back through here
+    if (replaying_)
+        return;
+
+    dropRedo();
+
+    Record record;
+    record.slot = slot;
+    record.id = nextId_++;
+    record.step = groupDepth_ > 0 ? groupStep_ : nextStep_++;
+    record.value = std::move(old);
+    record.cost = costOf(record);
+    bytes_ += record.cost;
+    records_.push_back(std::move(record));
+    cursor_++;
+
+    trim();
+}
+
+void SettingsJournal::dropRedo()
+{
+    while (records_.size() > cursor_) {
+        bytes_ -= records_.back().cost;
+        records_.pop_back();
+    }
+}
+
+void SettingsJournal::beginGroup()
+{
+    if (groupDepth_++ == 0)
+        groupStep_ = nextStep_++;
+}
+
+void SettingsJournal::endGroup()
+{
+    if (groupDepth_ > 0)
+        groupDepth_--;
+}
+
+bool SettingsJournal::undo(SettingsTable& table)
+{
+    if (!canUndo())
+        return false;
+
+    auto step = records_[cursor_ - 1].step;
+    while (cursor_ > 0 && records_[cursor_ - 1].step == step) {
+        cursor_--;
+        replay(table, records_[cursor_]);
+    }
+    return true;
+}
+
+bool SettingsJournal::redo(SettingsTable& table)
+{
+    if (!canRedo())
+        return false;
+
+    auto step = records_[cursor_].step;
+    while (cursor_ < records_.size() && records_[cursor_].step == step) {
+        replay(table, records_[cursor_]);
+        cursor_++;
+    }
+    return true;
+}
+
+bool SettingsJournal::seek(SettingsTable& table, const uint64_t position)
+{
+    size_t target = 0;
+    if (position != floorId_) {
+        // ids only go up along the log
+        auto it = std::lower_bound(records_.begin(), records_.end(), position,
+            [](const Record& record, const uint64_t id) { return record.id < id; });
+        if (it == records_.end() || it->id != position)
+            return false;
+        target = static_cast<size_t>(it - records_.begin()) + 1;
+    }
+
+    while (cursor_ > target) {
+        cursor_--;
+        replay(table, records_[cursor_]);
+    }
+    while (cursor_ < target) {
+        replay(table, records_[cursor_]);
+        cursor_++;
+    }
+    return true;
+}
+
+void SettingsJournal::replay(SettingsTable& table, Record& record)
+{
+    replaying_ = true;
+    table.exchange(record.slot, record.value);
+    replaying_ = false;
+
+    bytes_ -= record.cost;
+    record.cost = costOf(record);
+    bytes_ += record.cost;
+}
+
+void SettingsJournal::trim()
+{
+    // undone records go first, as the least likely to be wanted
+    while (bytes_ > budget_ && records_.size() > cursor_) {
+        bytes_ -= records_.back().cost;
+        records_.pop_back();
+    }
+
+    // then a whole step at a time, and never the one still being written
+    while (bytes_ > budget_ && cursor_ > 0) {
+        auto step = records_.front().step;
+        if (groupDepth_ > 0 && step == groupStep_)
+            break;
+
+        while (!records_.empty() && cursor_ > 0 && records_.front().step == step) {
+            bytes_ -= records_.front().cost;
+            floorId_ = records_.front().id;
+            records_.pop_front();
+            cursor_--;
+        }
+    }
+}
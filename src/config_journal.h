@@ -0,0 +1,74 @@
+#pragma once
+#ifndef __SRG_CONFIG_JOURNAL_HEADER__
+#define __SRG_CONFIG_JOURNAL_HEADER__
+
+#include "config_table.h"
+#include <deque>
+
+///
+/// Undo history for a SettingsTable, as a log of (slot, old value)
+/// records.  Stepping back swaps a record's value with the table's, so
+/// the record then holds what redo needs, and nothing is ever copied.
+/// Records made between beginGroup and endGroup undo as one step.
+/// The log is bounded in bytes; the oldest steps fall off the front.
+/// A position is the id of the last record applied.  Ids are never
+/// reused, so a savepoint can't land on an edit made after an undo, and
+/// one whose record has been dropped simply can't be gone back to.
+///
+class SettingsJournal
+{
+public:
+    SettingsJournal() = default;
+
+    void clear();
+    void setBudget(const size_t bytes);
+    size_t budget() const { return budget_; }
+    size_t bytes() const { return bytes_; }
+
+    // from the table, whenever a value changes.  drops anything undone.
+    void record(const SettingsTable::slot_t slot, SettingsTable::Value&& old);
+    // drops anything undone, so it can't be redone anymore
+    void dropRedo();
+
+    void beginGroup();
+    void endGroup();
+
+    bool canUndo() const { return cursor_ > 0; }
+    bool canRedo() const { return cursor_ < records_.size(); }
+    bool undo(SettingsTable& table);
+    bool redo(SettingsTable& table);
+
+    uint64_t position() const { return cursor_ > 0 ? records_[cursor_ - 1].id : floorId_; }
+    // undoes or redoes up to a position taken earlier.  false if its
+    // record has been trimmed away, or dropped with an undone branch.
+    bool seek(SettingsTable& table, const uint64_t position);
+
+private:
+    struct Record {
+        SettingsTable::slot_t slot{};
+        uint64_t id{};
+        uint64_t step{};
+        // what was counted for it, since swaps change the string's size
+        size_t cost{};
+        SettingsTable::Value value{};
+    };
+
+    std::deque<Record> records_{};
+    // records before this are applied, the rest have been undone
+    size_t cursor_{};
+    // the position with nothing in the log applied
+    uint64_t floorId_{};
+    uint64_t nextId_{ 1 };
+    uint64_t nextStep_{};
+    int groupDepth_{};
+    uint64_t groupStep_{};
+    size_t bytes_{};
+    size_t budget_{ 64 * 1024 };
+    bool replaying_{};
+
+    static size_t costOf(const Record& record) { return sizeof(Record) + record.value.text.capacity(); }
+    void replay(SettingsTable& table, Record& record);
+    void trim();
+};
+
+#endif /// __SRG_CONFIG_JOURNAL_HEADER__
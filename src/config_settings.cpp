@@ -1,6 +1,7 @@
 
 #include "config_settings.h"
 #include "common_utils.h"
+#include <algorithm>
 #include <godot_cpp/classes/dir_access.hpp>
 #include <godot_cpp/classes/file_access.hpp>
 
@@ -26,6 +27,34 @@ void ConfigItem::_bind_methods()
     BIND_ENUM_CONSTANT(T_STRING);
 }
 
+ConfigItem::ConfigItem(const ConfigValueType type)
+    : own_(std::make_unique<SettingsTable>())
+{
+    table_ = own_.get();
+    slot_ = own_->add(std::string(), static_cast<SettingsTable::ValueType>(type));
+}
+
+void ConfigItem::bindTo(SettingsTable* table, const SettingsTable::slot_t slot)
+{
+    table_ = table;
+    slot_ = slot;
+    own_.reset();
+}
+
+void ConfigItem::detach()
+{
+    if (own_ != nullptr)
+        return;
+
+    auto own = std::make_unique<SettingsTable>();
+    auto slot = own->add(table_->nameOf(slot_), table_->typeOf(slot_));
+    own->copyValue(slot, *table_, slot_);
+    own->touch(slot);
+    own_ = std::move(own);
+    table_ = own_.get();
+    slot_ = slot;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////
 
 void BoolConfigItem::_bind_methods()
@@ -84,6 +113,10 @@ ConfigItem* StringConfigItem::create(const std::string& value)
 
 void ConfigItems::_bind_methods()
 {
+    DECLARE_PROPERTY(ConfigItems, PerSettingSignals, state, Variant::BOOL);
+    DECLARE_PROPERTY(ConfigItems, UndoHistory, state, Variant::BOOL);
+    DECLARE_PROPERTY(ConfigItems, UndoBudget, bytes, Variant::INT);
+
     ClassDB::bind_method(D_METHOD("mark"), &ConfigItems::mark);
     ClassDB::bind_method(D_METHOD("restore"), &ConfigItems::restore);
     ClassDB::bind_method(D_METHOD("touch"), &ConfigItems::touch);
@@ -107,8 +140,31 @@ void ConfigItems::_bind_methods()
 
     ClassDB::bind_method(D_METHOD("getSettings"), &ConfigItems::getSettings);
 
+    ClassDB::bind_method(D_METHOD("undo"), &ConfigItems::undo);
+    ClassDB::bind_method(D_METHOD("redo"), &ConfigItems::redo);
+    ClassDB::bind_method(D_METHOD("canUndo"), &ConfigItems::canUndo);
+    ClassDB::bind_method(D_METHOD("canRedo"), &ConfigItems::canRedo);
+    ClassDB::bind_method(D_METHOD("beginUndoGroup"), &ConfigItems::beginUndoGroup);
+    ClassDB::bind_method(D_METHOD("endUndoGroup"), &ConfigItems::endUndoGroup);
+    ClassDB::bind_method(D_METHOD("savepoint"), &ConfigItems::savepoint);
+    ClassDB::bind_method(D_METHOD("rollbackTo", "position"), &ConfigItems::rollbackTo);
+    ClassDB::bind_method(D_METHOD("clearUndoHistory"), &ConfigItems::clearUndoHistory);
+    ClassDB::bind_method(D_METHOD("subscribe", "key", "callback"), &ConfigItems::subscribe);
+    ClassDB::bind_method(D_METHOD("unsubscribe", "key", "callback"), &ConfigItems::unsubscribe);
+
+    ClassDB::bind_method(D_METHOD("getBoolHandle", "name", "defaultValue"), &ConfigItems::getBoolHandle);
+    ClassDB::bind_method(D_METHOD("getIntHandle", "name", "defaultValue"), &ConfigItems::getIntHandle);
+    ClassDB::bind_method(D_METHOD("getFloatHandle", "name", "defaultValue"), &ConfigItems::getFloatHandle);
+    ClassDB::bind_method(D_METHOD("getStringHandle", "name", "defaultValue"), &ConfigItems::getStringHandle);
+    ClassDB::bind_method(D_METHOD("readBoolHandle", "handle"), &ConfigItems::readBoolHandle);
+    ClassDB::bind_method(D_METHOD("readIntHandle", "handle"), &ConfigItems::readIntHandle);
+    ClassDB::bind_method(D_METHOD("readFloatHandle", "handle"), &ConfigItems::readFloatHandle);
+    ClassDB::bind_method(D_METHOD("readStringHandle", "handle"), &ConfigItems::readStringHandle);
+
     ADD_SIGNAL(MethodInfo("apply_setting", PropertyInfo(Variant::STRING, "setting_name"),
         PropertyInfo(Variant::OBJECT, "setting", PROPERTY_HINT_OBJECT_ID, "ConfigItem")));
+    ADD_SIGNAL(MethodInfo("settings_applied", PropertyInfo(Variant::PACKED_STRING_ARRAY, "names"),
+        PropertyInfo(Variant::ARRAY, "values")));
 }
 
 ConfigItem* ConfigItems::getSetting(String name)
@@ -118,61 +174,91 @@ ConfigItem* ConfigItems::getSetting(String name)
 
 ConfigItems::~ConfigItems()
 {
-    for (auto& item : settings_) {
-        memdelete(item.second);
+    for (auto item : proxies_) {
+        if (item != nullptr)
+            memdelete(item);
+    }
+    for (auto item : detached_) {
+        memdelete(item);
+    }
+}
+
+ConfigItem* ConfigItems::proxyFor(const SettingsTable::slot_t slot)
+{
+    if (slot >= proxies_.size())
+        proxies_.resize(slot + 1, nullptr);
+
+    auto& proxy = proxies_[slot];
+    if (proxy == nullptr && !detached_.empty())
+        proxy = takeDetached(slot);
+    if (proxy == nullptr) {
+        switch (table_.typeOf(slot)) {
+        case SettingsTable::T_BOOL: proxy = memnew(BoolConfigItem); break;
+        case SettingsTable::T_INT: proxy = memnew(IntConfigItem); break;
+        case SettingsTable::T_FLOAT: proxy = memnew(FloatConfigItem); break;
+        case SettingsTable::T_STRING: proxy = memnew(StringConfigItem); break;
+        default: proxy = memnew(ConfigItem); break;
+        }
+        proxy->bindTo(&table_, slot);
     }
+
+    return proxy;
+}
+
+ConfigItem* ConfigItems::takeDetached(const SettingsTable::slot_t slot)
+{
+    auto& name = table_.nameOf(slot);
+    auto type = table_.typeOf(slot);
+    auto it = std::find_if(detached_.begin(), detached_.end(), [&](const ConfigItem* item) {
+        return item->table_->typeOf(item->slot_) == type && item->table_->nameOf(item->slot_) == name;
+    });
+    if (it == detached_.end())
+        return nullptr;
+
+    auto item = *it;
+    detached_.erase(it);
+    item->bindTo(&table_, slot);
+    return item;
 }
 
 ConfigItem* ConfigItems::getSetting_(const std::string& name, bool autoCreate)
 {
-    auto iter = settings_.find(name);
-    if (iter != settings_.end())
-        return iter->second;
+    auto slot = table_.find(name);
+    if (slot != SettingsTable::npos)
+        return proxyFor(slot);
 
     return nullptr;
 }
 
-Dictionary ConfigItems::getSettings() const
+Dictionary ConfigItems::getSettings()
 {
     Dictionary result;
 
-    for (auto& item : settings_) {
-        result[String(item.first.data())] = item.second;
-    }
+    table_.forEach([&](const std::string& name, const SettingsTable::slot_t slot) {
+        result[String(name.data())] = proxyFor(slot);
+    });
 
     return result;
 }
 
 void ConfigItems::mark()
 {
-    for (auto& item : settings_) {
-        (item.second)->mark();
-    }
+    table_.markAll();
 }
 
 void ConfigItems::restore()
 {
-    for (auto& item : settings_) {
-        (item.second)->restore();
-    }
+    table_.restoreAll();
 }
 
 void ConfigItems::touch()
 {
-    for (auto& item : settings_) {
-        (item.second)->touch();
-    }
+    table_.touchAll();
 }
 
 bool ConfigItems::hasChanges() const
 {
-    for (auto& item : settings_) {
-        if ((item.second)->hasChanged()) {
-            return true;
-        }
-    }
-
-    return false;
+    return table_.anyChanged();
 }
 
 ConfigItem* ConfigItems::add(const std::string& name, ConfigItem* setting)
@@ -180,59 +266,101 @@ ConfigItem* ConfigItems::add(const std::string& name, ConfigItem* setting)
     // note that the item passed in WILL NOT be added if the
     // 'name' entry is already occupied!  instead, it will
     // be deallocated!  watch out!
-    auto it = settings_.find(name);
-    if (it == settings_.end()) {
-        settings_[name] = setting;
+    if (!setting->isBound() && !detached_.empty())
+        detached_.erase(std::remove(detached_.begin(), detached_.end(), setting), detached_.end());
+
+    auto slot = table_.find(name);
+    if (slot == SettingsTable::npos) {
+        slot = table_.add(name, static_cast<SettingsTable::ValueType>(setting->getType()));
+        table_.copyValue(slot, *setting->table_, setting->slot_);
+        // somebody else's item, so just take the value
+        if (setting->isBound())
+            return proxyFor(slot);
+
+        setting->bindTo(&table_, slot);
+        if (slot >= proxies_.size())
+            proxies_.resize(slot + 1, nullptr);
+        proxies_[slot] = setting;
+        return setting;
     }
-    else {
-        // same type. update the value of the existing one
-        if (it->second->isSameType(*setting)) {
-            it->second->copyFrom(*setting);
-        }
-        // we're not going to overwrite an existing item
-        // @TODO: maybe add an option to allow this?
-        memdelete(setting);
+
+    auto existing = proxyFor(slot);
+    if (existing == setting)
+        return existing;
+
+    // same type. update the value of the existing one
+    if (existing->isSameType(*setting)) {
+        existing->copyFrom(*setting);
     }
+    // we're not going to overwrite an existing item
+    // @TODO: maybe add an option to allow this?
+    if (!setting->isBound())
+        memdelete(setting);
 
-    return settings_[name];
+    return existing;
+}
+SettingsTable::slot_t ConfigItems::add(const std::string& name, bool value)
+{
+    auto slot = table_.add(name, SettingsTable::T_BOOL);
+    if (table_.typeOf(slot) == SettingsTable::T_BOOL)
+        table_.setBool(slot, value);
+    return slot;
 }
-ConfigItem* ConfigItems::add(const std::string& name, bool value)
+SettingsTable::slot_t ConfigItems::add(const std::string& name, int64_t value)
 {
-    return add(name, BoolConfigItem::create(value));
+    auto slot = table_.add(name, SettingsTable::T_INT);
+    if (table_.typeOf(slot) == SettingsTable::T_INT)
+        table_.setInt(slot, value);
+    return slot;
 }
-ConfigItem* ConfigItems::add(const std::string& name, int64_t value)
+SettingsTable::slot_t ConfigItems::add(const std::string& name, double value)
 {
-    return add(name, IntConfigItem::create(value));
+    auto slot = table_.add(name, SettingsTable::T_FLOAT);
+    if (table_.typeOf(slot) == SettingsTable::T_FLOAT)
+        table_.setFloat(slot, value);
+    return slot;
 }
-ConfigItem* ConfigItems::add(const std::string& name, double value)
+SettingsTable::slot_t ConfigItems::add(const std::string& name, const std::string& value)
 {
-    return add(name, FloatConfigItem::create(value));
+    auto slot = table_.add(name, SettingsTable::T_STRING);
+    if (table_.typeOf(slot) == SettingsTable::T_STRING)
+        table_.setString(slot, value);
+    return slot;
 }
-ConfigItem* ConfigItems::add(const std::string& name, const std::string& value)
+
+SettingsTable::slot_t ConfigItems::add(const std::string& name, const String value)
 {
-    return add(name, StringConfigItem::create(value));
+    return add(name, translate(value));
 }
 
-ConfigItem* ConfigItems::add(const std::string& name, const String value)
+SettingsTable::slot_t ConfigItems::findSlot(const StringName& name)
 {
-    return add(name, StringConfigItem::create(translate(value)));
+    uint32_t hash = name.hash();
+    auto slot = nameKeys_.find(name, hash);
+    if (slot != SettingsTable::npos)
+        return slot;
+
+    // first time we see this one
+    slot = table_.find(translate(String(name)));
+    if (slot != SettingsTable::npos)
+        nameKeys_.remember(name, hash, slot);
+    return slot;
 }
 
-template<typename T, ConfigItem::ConfigValueType U, typename V>
-T ConfigItems::get(const std::string& name, T defaultValue)
+template<typename T, SettingsTable::ValueType U>
+T ConfigItems::get(const StringName& name, T defaultValue)
 {
-    ConfigItem* setting = getSetting_(name, false);
-    if (setting != nullptr) {
-        auto dataType = setting->getType();
-        if (dataType == U) {
-            return (static_cast<V*>(setting))->getValue();
+    auto slot = findSlot(name);
+    if (slot != SettingsTable::npos) {
+        if (table_.typeOf(slot) == U) {
+            T value;
+            readSlot(slot, value);
+            return value;
         }
+        remove(translate(String(name)));
     }
 
-    if (setting != nullptr) {
-        remove(name);
-    }
-    add(name, defaultValue);
+    add(translate(String(name)), defaultValue);
     return defaultValue;
 }
 
@@ -242,46 +370,271 @@ ConfigItem* ConfigItems::addSetting(String name, ConfigItem* setting)
 }
 ConfigItem* ConfigItems::addBoolSetting(String name, bool value)
 {
-    return add(translate(name), value);
+    return proxyFor(add(translate(name), value));
 }
 ConfigItem* ConfigItems::addIntSetting(String name, int64_t value)
 {
-    return add(translate(name), value);
+    return proxyFor(add(translate(name), value));
 }
 ConfigItem* ConfigItems::addFloatSetting(String name, double value)
 {
-    return add(translate(name), value);
+    return proxyFor(add(translate(name), value));
 }
 ConfigItem* ConfigItems::addStringSetting(String name, String value)
 {
-    return add(translate(name), translate(value));
+    return proxyFor(add(translate(name), translate(value)));
+}
+
+bool ConfigItems::readBoolSetting(const StringName& name, bool defaultValue)
+{
+    return get<bool, SettingsTable::T_BOOL>(name, defaultValue);
+}
+int64_t ConfigItems::readIntSetting(const StringName& name, int64_t defaultValue)
+{
+    return get<int64_t, SettingsTable::T_INT>(name, defaultValue);
+}
+double ConfigItems::readFloatSetting(const StringName& name, double defaultValue)
+{
+    return get<double, SettingsTable::T_FLOAT>(name, defaultValue);
+}
+String ConfigItems::readStringSetting(const StringName& name, String defaultValue)
+{
+    return get<String, SettingsTable::T_STRING>(name, defaultValue);
+}
+
+SettingsTable::slot_t ConfigItems::handleIndex(const String& name, const SettingsTable::ValueType type, bool& created)
+{
+    auto key = translate(name);
+    auto index = defaults_.find(key);
+    created = index == SettingsTable::npos;
+    if (created) {
+        index = defaults_.add(key, type);
+        bound_.push_back(SettingsTable::npos);
+    }
+    else if (defaults_.typeOf(index) != type) {
+        DEBUG("Setting already has a handle of another type.");
+        return SettingsTable::npos;
+    }
+
+    return index;
+}
+
+int64_t ConfigItems::makeHandle(const SettingsTable::slot_t index)
+{
+    if (index == SettingsTable::npos)
+        return -1;
+
+    rebind(index);
+    return (static_cast<int64_t>(index) << HANDLE_TYPE_BITS) | defaults_.typeOf(index);
+}
+
+SettingsTable::slot_t ConfigItems::rebind(const SettingsTable::slot_t index)
+{
+    auto& name = defaults_.nameOf(index);
+    auto type = defaults_.typeOf(index);
+
+    auto slot = table_.find(name);
+    if (slot != SettingsTable::npos && table_.typeOf(slot) != type) {
+        remove(name);
+        slot = SettingsTable::npos;
+    }
+    if (slot == SettingsTable::npos) {
+        slot = table_.add(name, type);
+        table_.copyValue(slot, defaults_, index);
+    }
+
+    bound_[index] = slot;
+    return slot;
 }
 
-bool ConfigItems::readBoolSetting(String name, bool defaultValue)
+int64_t ConfigItems::getBoolHandle(String name, bool defaultValue)
 {
-    return get<bool, ConfigItem::T_BOOL, BoolConfigItem>(translate(name), defaultValue);
+    bool created = false;
+    auto index = handleIndex(name, SettingsTable::T_BOOL, created);
+    if (created)
+        defaults_.setBool(index, defaultValue);
+    return makeHandle(index);
 }
-int64_t ConfigItems::readIntSetting(String name, int64_t defaultValue)
+int64_t ConfigItems::getIntHandle(String name, int64_t defaultValue)
 {
-    return get<int64_t, ConfigItem::T_INT, IntConfigItem>(translate(name), defaultValue);
+    bool created = false;
+    auto index = handleIndex(name, SettingsTable::T_INT, created);
+    if (created)
+        defaults_.setInt(index, defaultValue);
+    return makeHandle(index);
 }
-double ConfigItems::readFloatSetting(String name, double defaultValue)
+int64_t ConfigItems::getFloatHandle(String name, double defaultValue)
 {
-    return get<double, ConfigItem::T_FLOAT, FloatConfigItem>(translate(name), defaultValue);
+    bool created = false;
+    auto index = handleIndex(name, SettingsTable::T_FLOAT, created);
+    if (created)
+        defaults_.setFloat(index, defaultValue);
+    return makeHandle(index);
 }
-String ConfigItems::readStringSetting(String name, String defaultValue)
+int64_t ConfigItems::getStringHandle(String name, String defaultValue)
 {
-    return get<String, ConfigItem::T_STRING, StringConfigItem>(translate(name), defaultValue);
+    bool created = false;
+    auto index = handleIndex(name, SettingsTable::T_STRING, created);
+    if (created)
+        defaults_.setString(index, translate(defaultValue));
+    return makeHandle(index);
+}
+
+void ConfigItems::setUndoHistory(const bool state)
+{
+    undoHistory_ = state;
+    table_.setJournal(state ? &journal_ : nullptr);
+    if (!state)
+        journal_.clear();
+}
+
+bool ConfigItems::rollbackTo(const int64_t position)
+{
+    return position >= 0 && journal_.seek(table_, static_cast<uint64_t>(position));
 }
 
 // this should seldom happen!
 void ConfigItems::remove(const std::string& settingName)
 {
-    auto iter = settings_.find(settingName);
-    if (iter != settings_.end()) {
-        auto item = iter->second;
-        memdelete(item);
-        settings_.erase(iter);
+    auto slot = table_.find(settingName);
+    if (slot == SettingsTable::npos)
+        return;
+
+    if (slot < proxies_.size() && proxies_[slot] != nullptr) {
+        memdelete(proxies_[slot]);
+        proxies_[slot] = nullptr;
+    }
+    table_.remove(settingName);
+    nameKeys_.clear();
+    std::fill(bound_.begin(), bound_.end(), SettingsTable::npos);
+}
+
+void ConfigItems::clear()
+{
+    for (auto& item : proxies_) {
+        if (item != nullptr) {
+            item->detach();
+            detached_.push_back(item);
+        }
+    }
+    proxies_.clear();
+    table_.clear();
+    // the slots in there are gone
+    journal_.clear();
+    nameKeys_.clear();
+    std::fill(bound_.begin(), bound_.end(), SettingsTable::npos);
+}
+
+void ConfigItems::reattach()
+{
+    // proxyFor takes them off detached_, so walk a copy
+    auto pending = detached_;
+    for (auto item : pending) {
+        auto slot = table_.find(item->table_->nameOf(item->slot_));
+        if (slot != SettingsTable::npos)
+            proxyFor(slot);
+    }
+}
+
+Variant ConfigItems::valueOf(const SettingsTable::slot_t slot) const
+{
+    switch (table_.typeOf(slot)) {
+    case SettingsTable::T_BOOL: return table_.getBool(slot);
+    case SettingsTable::T_INT: return table_.getInt(slot);
+    case SettingsTable::T_FLOAT: return table_.getFloat(slot);
+    case SettingsTable::T_STRING: return translate(table_.getString(slot));
+    default: return Variant();
+    }
+}
+
+void ConfigItems::emitApplied(const std::vector<SettingsTable::slot_t>& slots, const bool touch)
+{
+    if (slots.empty())
+        return;
+
+    PackedStringArray names;
+    Array values;
+    names.resize(slots.size());
+    values.resize(slots.size());
+
+    for (size_t i = 0; i < slots.size(); i++) {
+        auto slot = slots[i];
+        auto& name = table_.nameOf(slot);
+        String item_name(name.data());
+        auto value = valueOf(slot);
+        names.set(i, item_name);
+        values[i] = value;
+
+        if (!exactSubscribers_.empty() || !prefixSubscribers_.empty())
+            notifySubscribers(name, item_name, value);
+
+        if (perSettingSignals_)
+            emit_signal("apply_setting", item_name, proxyFor(slot));
+        if (touch)
+            table_.touch(slot);
+    }
+    // one at a time, so anything a subscriber changed meanwhile stays
+    // pending, then the applied ones come off the dirty list together
+    if (touch)
+        table_.pruneDirty();
+
+    emit_signal("settings_applied", names, values);
+}
+
+void ConfigItems::subscribe(String key, Callable callback)
+{
+    auto name = translate(key);
+    bool prefix = name.empty() || name.back() == '.';
+    auto& list = (prefix ? prefixSubscribers_ : exactSubscribers_)[name];
+    if (std::find(list.begin(), list.end(), callback) == list.end())
+        list.push_back(callback);
+}
+
+void ConfigItems::unsubscribe(String key, Callable callback)
+{
+    auto name = translate(key);
+    bool prefix = name.empty() || name.back() == '.';
+    auto& subscribers = prefix ? prefixSubscribers_ : exactSubscribers_;
+    auto it = subscribers.find(name);
+    if (it == subscribers.end())
+        return;
+
+    auto& list = it->second;
+    list.erase(std::remove(list.begin(), list.end(), callback), list.end());
+    if (list.empty())
+        subscribers.erase(it);
+}
+
+void ConfigItems::notifySubscribers(const std::string& name, const String& itemName, const Variant& value)
+{
+    if (!exactSubscribers_.empty())
+        notifyList(exactSubscribers_, name, itemName, value);
+
+    if (prefixSubscribers_.empty())
+        return;
+
+    notifyList(prefixSubscribers_, std::string(), itemName, value);
+    for (auto dot = name.find('.'); dot != std::string::npos; dot = name.find('.', dot + 1)) {
+        notifyList(prefixSubscribers_, name.substr(0, dot + 1), itemName, value);
+    }
+}
+
+void ConfigItems::notifyList(subscribers_t& subscribers, const std::string& key, const String& itemName, const Variant& value)
+{
+    auto it = subscribers.find(key);
+    if (it == subscribers.end())
+        return;
+
+    // drop callbacks whose object went away, then call a copy, so a
+    // callback can subscribe or unsubscribe while we're at it
+    auto& list = it->second;
+    list.erase(std::remove_if(list.begin(), list.end(), [](const Callable& callback) { return !callback.is_valid(); }), list.end());
+    auto callbacks = list;
+    if (list.empty())
+        subscribers.erase(it);
+
+    for (auto& callback : callbacks) {
+        callback.call(itemName, value);
     }
 }
 
@@ -290,46 +643,31 @@ void ConfigItems::applyChanges()
     if (!hasChanges())
         return;
 
-    for (auto& item : settings_) {
-        auto setting = item.second;
-        if (setting->hasChanged()) {
-            String item_name(item.first.data());
-            emit_signal("apply_setting", item_name, setting);
-            setting->touch();
-        }
-    }
+    std::vector<SettingsTable::slot_t> changed;
+    table_.changedSlots(changed);
+    emitApplied(changed, true);
 }
 
 void ConfigItems::forceApplyChanges()
 {
-    for (auto& item : settings_) {
-        auto setting = item.second;
-        String item_name(item.first.data());
-        emit_signal("apply_setting", item_name, setting);
-    }
+    std::vector<SettingsTable::slot_t> all;
+    all.reserve(table_.size());
+    table_.forEach([&](const std::string& name, const SettingsTable::slot_t slot) {
+        all.push_back(slot);
+    });
+    emitApplied(all, false);
 }
 
 void ConfigItems::undoPendingChanges()
 {
-    for (auto& item : settings_) {
-        (item.second)->restore();
-    }
+    table_.restoreAll();
 }
 
 void ConfigItems::updateFrom(ConfigItems* source)
 {
-    for (auto& item : source->settings_) {
-        auto setting = item.second;
-        auto& name = item.first;
-        auto item = settings_.find(name);
-        if (item == settings_.end()) {
-            ConfigItem* new_setting = memnew(ConfigItem);
-            new_setting->copyFrom(*setting);
-            settings_[name] = new_setting;
-        }
-        else {
-            (item->second)->copyFrom(*setting);
-        }
-    }
+    auto& from = source->table_;
+    from.forEach([&](const std::string& name, const SettingsTable::slot_t sourceSlot) {
+        auto slot = table_.add(name, from.typeOf(sourceSlot));
+        table_.copyValue(slot, from, sourceSlot);
+    });
 }
-
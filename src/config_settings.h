@@ -4,53 +4,56 @@
 
 #include "../../SrgGdHelpers/include/__templates.hpp"
 #include <godot_cpp/variant/dictionary.hpp>
-#include "undoable.hpp"
+#include "config_journal.h"
+#include "config_table.h"
+#include "name_index.h"
+#include <memory>
 #include <string>
-
+#include <unordered_map>
+
+///
+/// One setting, as seen from scripts.  Inside a ConfigItems collection
+/// this is only a view on a slot in the collection's table, made when
+/// something asks for it.  Made on its own (with new(), or create()),
+/// it keeps its value in a one-slot table of its own instead.
+///
 class ConfigItem GDX_SUBCLASS(Node)
 {
     GDX_CLASS_PREFIX(ConfigItem, Node);
 
 public:
-    ConfigItem() = default;
+    ConfigItem() : ConfigItem(T_BLANK) {}
     virtual ~ConfigItem() = default;
 
     enum ConfigValueType { T_BLANK = 0, T_BOOL, T_INT, T_FLOAT, T_STRING };
 
-    void mark() {
-        changed_ = false;
-        internalMark();
-    }
-    void restore() {
-        if (changed_) {
-            internalRestore();
-            changed_ = false;
-        }
-    }
-    void touch() {
-        if (changed_) {
-            internalTouch();
-            changed_ = false;
-        }
-    }
-    bool hasChanged() const { return changed_; }
+    void mark() { table_->mark(slot_); }
+    void restore() { table_->restore(slot_); }
+    void touch() { table_->touch(slot_); }
+    bool hasChanged() const { return table_->hasChanged(slot_); }
 
-    bool isSameType(const ConfigItem & other) { return type_ == other.type_; }
+    bool isSameType(const ConfigItem & other) { return getType() == other.getType(); }
     void copyFrom(const ConfigItem & other) {
         if (isSameType(other))
-            performCopy(other);
+            table_->copyValue(slot_, *other.table_, other.slot_);
     }
 
-    ConfigValueType getType() const { return type_; }
+    ConfigValueType getType() const { return static_cast<ConfigValueType>(table_->typeOf(slot_)); }
+
+    // for ConfigItems.  points the item at a slot in the collection's
+    // table, or, with detach, back at a copy of its own.
+    bool isBound() const { return own_ == nullptr; }
+    void bindTo(SettingsTable* table, const SettingsTable::slot_t slot);
+    void detach();
+    SettingsTable::slot_t getSlot() const { return slot_; }
 
 protected:
-    ConfigValueType type_{ ConfigValueType::T_BLANK };
-    bool changed_{};
+    friend class ConfigItems;
+    explicit ConfigItem(const ConfigValueType type);
 
-    virtual void internalMark() {}
-    virtual void internalRestore() {}
-    virtual void internalTouch() {}
-    virtual void performCopy(const ConfigItem& other) {}
+    SettingsTable* table_{};
+    SettingsTable::slot_t slot_{};
+    std::unique_ptr<SettingsTable> own_{};
 };
 
 VARIANT_ENUM_CAST(ConfigItem::ConfigValueType);
@@ -60,31 +63,14 @@ class BoolConfigItem GDX_SUBCLASS(ConfigItem)
     GDX_CLASS_PREFIX(BoolConfigItem, ConfigItem);
 
 public:
-    BoolConfigItem() { type_ = T_BOOL; }
+    BoolConfigItem() : ConfigItem(T_BOOL) {}
     virtual ~BoolConfigItem() = default;
 
-    bool getValue() const { return value_; }
-    void setValue(const bool value) {
-        value_ = value;
-        changed_ = value_.hasChanged();
-    }
+    bool getValue() const { return table_->getBool(slot_); }
+    void setValue(const bool value) { table_->setBool(slot_, value); }
 
-    operator bool() { return value_; }
+    operator bool() { return getValue(); }
     static ConfigItem* create(const bool value);
-
-protected:
-    virtual void internalMark() { value_.mark(); }
-    virtual void internalRestore() { value_.restore(); }
-    virtual void internalTouch() { value_.touch(); }
-    virtual void performCopy(const ConfigItem & other) {
-        auto otherValue = (dynamic_cast<const BoolConfigItem&>(other)).value_;
-        if (value_ != otherValue) {
-            setValue(otherValue);
-        }
-    }
-
-private:
-    undoable_t<bool> value_{};
 };
 
 class IntConfigItem GDX_SUBCLASS(ConfigItem)
@@ -92,31 +78,14 @@ class IntConfigItem GDX_SUBCLASS(ConfigItem)
     GDX_CLASS_PREFIX(IntConfigItem, ConfigItem);
 
 public:
-    IntConfigItem() { type_ = T_INT; }
+    IntConfigItem() : ConfigItem(T_INT) {}
     virtual ~IntConfigItem() = default;
 
-    int64_t getValue() const { return value_; }
-    void setValue(const int64_t value) {
-        value_ = value;
-        changed_ = value_.hasChanged();
-    }
+    int64_t getValue() const { return table_->getInt(slot_); }
+    void setValue(const int64_t value) { table_->setInt(slot_, value); }
 
-    operator int64_t() { return value_; }
+    operator int64_t() { return getValue(); }
     static ConfigItem* create(const int64_t value);
-
-protected:
-    virtual void internalMark() { value_.mark(); }
-    virtual void internalRestore() { value_.restore(); }
-    virtual void internalTouch() { value_.touch(); }
-    virtual void performCopy(const ConfigItem & other) {
-        auto otherValue = (dynamic_cast<const IntConfigItem&>(other)).value_;
-        if (value_ != otherValue) {
-            setValue(otherValue);
-        }
-    }
-
-private:
-    undoable_t<int64_t> value_{};
 };
 
 class FloatConfigItem GDX_SUBCLASS(ConfigItem)
@@ -124,31 +93,14 @@ class FloatConfigItem GDX_SUBCLASS(ConfigItem)
     GDX_CLASS_PREFIX(FloatConfigItem, ConfigItem);
 
 public:
-    FloatConfigItem() { type_ = T_FLOAT; }
+    FloatConfigItem() : ConfigItem(T_FLOAT) {}
     virtual ~FloatConfigItem() = default;
 
-    double getValue() const { return value_; }
-    void setValue(const double value) {
-        value_ = value;
-        changed_ = value_.hasChanged();
-    }
+    double getValue() const { return table_->getFloat(slot_); }
+    void setValue(const double value) { table_->setFloat(slot_, value); }
 
-    operator double() { return value_; }
+    operator double() { return getValue(); }
     static ConfigItem* create(const double value);
-
-protected:
-    virtual void internalMark() { value_.mark(); }
-    virtual void internalRestore() { value_.restore(); }
-    virtual void internalTouch() { value_.touch(); }
-    virtual void performCopy(const ConfigItem & other) {
-        auto otherValue = (dynamic_cast<const FloatConfigItem&>(other)).value_;
-        if (value_ != otherValue) {
-            setValue(otherValue);
-        }
-    }
-
-private:
-    undoable_t<double> value_{};
 };
 
 class StringConfigItem GDX_SUBCLASS(ConfigItem)
@@ -156,32 +108,15 @@ class StringConfigItem GDX_SUBCLASS(ConfigItem)
     GDX_CLASS_PREFIX(StringConfigItem, ConfigItem);
 
 public:
-    StringConfigItem() { type_ = T_STRING; }
+    StringConfigItem() : ConfigItem(T_STRING) {}
     virtual ~StringConfigItem() = default;
 
-    String getValue() const { return translate(value_); }
-    void setValue(const String value) {
-        value_ = translate(value);
-        changed_ = value_.hasChanged();
-    }
-    void setStdStringValue(const std::string& value) {
-        value_ = value;
-        changed_ = value_.hasChanged();
-    }
+    String getValue() const { return translate(table_->getString(slot_)); }
+    void setValue(const String value) { table_->setString(slot_, translate(value)); }
+    void setStdStringValue(const std::string& value) { table_->setString(slot_, value); }
 
-    operator std::string() { return value_; }
+    operator std::string() { return table_->getString(slot_); }
     static ConfigItem* create(const std::string& value);
-
-protected:
-    virtual void internalMark() { value_.mark(); }
-    virtual void internalRestore() { value_.restore(); }
-    virtual void internalTouch() { value_.touch(); }
-    virtual void performCopy(const ConfigItem & other) {
-        setStdStringValue((dynamic_cast<const StringConfigItem&>(other)).value_);
-    }
-
-private:
-    undoable_t<std::string> value_{};
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -194,22 +129,24 @@ public:
     ConfigItems() = default;
     virtual ~ConfigItems();
 
-    using settings_list_t = std::map<std::string, ConfigItem*>;
-
     void mark();
     void restore();
     void touch();
     bool hasChanges() const;
 
+    // an existing setting of the same type takes the value, one of another
+    // type is left alone.  returns the setting's slot either way.
+    SettingsTable::slot_t add(const std::string & name, bool value);
+    SettingsTable::slot_t add(const std::string & name, int64_t value);
+    SettingsTable::slot_t add(const std::string & name, double value);
+    SettingsTable::slot_t add(const std::string & name, const std::string & value);
+    SettingsTable::slot_t add(const std::string& name, const String value);
+    // takes the item over, unless the name is taken, in which case the
+    // value is copied and the item deleted.  watch out!
     ConfigItem* add(const std::string & name, ConfigItem * setting);
-    ConfigItem* add(const std::string & name, bool value);
-    ConfigItem* add(const std::string & name, int64_t value);
-    ConfigItem* add(const std::string & name, double value);
-    ConfigItem* add(const std::string & name, const std::string & value);
-    ConfigItem* add(const std::string& name, const String value);
 
-    template<typename T, ConfigItem::ConfigValueType U, typename V>
-    T get(const std::string & name, T defaultValue);
+    template<typename T, SettingsTable::ValueType U>
+    T get(const StringName & name, T defaultValue);
 
     ConfigItem* addSetting(String name, ConfigItem * setting);
     ConfigItem* addBoolSetting(String name, bool value);
@@ -217,16 +154,54 @@ public:
     ConfigItem* addFloatSetting(String name, double value);
     ConfigItem* addStringSetting(String name, String value);
 
-    Dictionary getSettings() const;
-    // this will add the setting to the dictionary if it wasn't there yet
+    Dictionary getSettings();
     ConfigItem* getSetting(String name);
     ConfigItem* getSetting_(const std::string& name, bool autoCreate = true);
 
 
-    bool readBoolSetting(String name, bool defaultValue);
-    int64_t readIntSetting(String name, int64_t defaultValue);
-    double readFloatSetting(String name, double defaultValue);
-    String readStringSetting(String name, String defaultValue);
+    // these take a StringName, so reads with &"name" from scripts (or a
+    // cached StringName in C++) never convert the key to utf8
+    bool readBoolSetting(const StringName& name, bool defaultValue);
+    int64_t readIntSetting(const StringName& name, int64_t defaultValue);
+    double readFloatSetting(const StringName& name, double defaultValue);
+    String readStringSetting(const StringName& name, String defaultValue);
+
+    // handles resolve a name once, and reading through one is an array
+    // load.  they stay good across clear() and reloads, rebinding by name
+    // on the next read, and put the default back if the setting is gone.
+    // -1 if the name already has a handle of another type.
+    int64_t getBoolHandle(String name, bool defaultValue);
+    int64_t getIntHandle(String name, int64_t defaultValue);
+    int64_t getFloatHandle(String name, double defaultValue);
+    int64_t getStringHandle(String name, String defaultValue);
+
+    bool readBoolHandle(const int64_t handle) {
+        auto slot = boundSlot(handle, SettingsTable::T_BOOL);
+        return slot != SettingsTable::npos && table_.getBool(slot);
+    }
+    int64_t readIntHandle(const int64_t handle) {
+        auto slot = boundSlot(handle, SettingsTable::T_INT);
+        return slot != SettingsTable::npos ? table_.getInt(slot) : 0;
+    }
+    double readFloatHandle(const int64_t handle) {
+        auto slot = boundSlot(handle, SettingsTable::T_FLOAT);
+        return slot != SettingsTable::npos ? table_.getFloat(slot) : 0.0;
+    }
+    String readStringHandle(const int64_t handle) {
+        auto slot = boundSlot(handle, SettingsTable::T_STRING);
+        return slot != SettingsTable::npos ? translate(table_.getString(slot)) : String();
+    }
+
+    // per setting apply_setting signals, on top of the one batched
+    // settings_applied per pass.  off unless somebody needs them.
+    bool getPerSettingSignals() const { return perSettingSignals_; }
+    void setPerSettingSignals(const bool state) { perSettingSignals_ = state; }
+
+    // callback(name, value) for just the settings it cares about.  a
+    // key ending in a dot, like "audio.", matches everything under it,
+    // an empty one matches everything.  the rest are exact names.
+    void subscribe(String key, Callable callback);
+    void unsubscribe(String key, Callable callback);
 
     // this will iterate on changed values ONLY, and call the godot event.
     // after this, changed flags will be reset
@@ -239,12 +214,86 @@ public:
     // will also create items that didn't exist in our list.
     void updateFrom(ConfigItems * source);
 
-    const settings_list_t& getSettings_() const { return settings_; }
-    void clear() { settings_.clear(); }
+    // undo history over every change of value, however it was made.
+    // off by default; UndoBudget caps what it may hold, in bytes.
+    bool getUndoHistory() const { return undoHistory_; }
+    void setUndoHistory(const bool state);
+    int64_t getUndoBudget() const { return static_cast<int64_t>(journal_.budget()); }
+    void setUndoBudget(const int64_t bytes) { journal_.setBudget(static_cast<size_t>(bytes < 0 ? 0 : bytes)); }
+
+    bool undo() { return journal_.undo(table_); }
+    bool redo() { return journal_.redo(table_); }
+    bool canUndo() const { return journal_.canUndo(); }
+    bool canRedo() const { return journal_.canRedo(); }
+    // changes between these undo as one step.  they nest.
+    void beginUndoGroup() { journal_.beginGroup(); }
+    void endUndoGroup() { journal_.endGroup(); }
+    // a point to come back to with rollbackTo, like when a menu opens
+    int64_t savepoint() const { return static_cast<int64_t>(journal_.position()); }
+    bool rollbackTo(const int64_t position);
+    void clearUndoHistory() { journal_.clear(); }
+
+    const SettingsTable& getTable() const { return table_; }
+    // items handed out before this keep working, on a copy of their
+    // value, until reattach() (or asking for them again) finds their
+    // setting back in the collection
+    void clear();
+    // after a reload, binds detached items to the setting of the same
+    // name and type again, so they see the new value
+    void reattach();
 
 private:
-    settings_list_t settings_{};
-
+    SettingsTable table_{};
+    // the script side views, by slot.  only made on demand.
+    std::vector<ConfigItem*> proxies_{};
+    std::vector<ConfigItem*> detached_{};
+
+    // StringName keys seen so far, on the engine's own hash.  dropped
+    // as a whole whenever a slot goes away.
+    NameIndex<StringName> nameKeys_{};
+
+    // a handle is its index here shifted left by HANDLE_TYPE_BITS, with
+    // the value type in the low bits, so a read checks the type without
+    // touching memory.  defaults_ holds name, type and default per handle.
+    static constexpr int HANDLE_TYPE_BITS = 3;
+    SettingsTable defaults_{};
+    std::vector<SettingsTable::slot_t> bound_{};
+
+    SettingsTable::slot_t boundSlot(const int64_t handle, const SettingsTable::ValueType type) {
+        auto index = static_cast<uint64_t>(handle) >> HANDLE_TYPE_BITS;
+        if ((handle & ((1 << HANDLE_TYPE_BITS) - 1)) != type || index >= bound_.size())
+            return SettingsTable::npos;
+        auto slot = bound_[index];
+        return slot != SettingsTable::npos ? slot : rebind(static_cast<SettingsTable::slot_t>(index));
+    }
+    SettingsTable::slot_t rebind(const SettingsTable::slot_t index);
+    SettingsTable::slot_t handleIndex(const String& name, const SettingsTable::ValueType type, bool& created);
+    int64_t makeHandle(const SettingsTable::slot_t index);
+
+    SettingsTable::slot_t findSlot(const StringName& name);
+
+    bool perSettingSignals_{};
+    bool undoHistory_{};
+    SettingsJournal journal_{};
+
+    // by exact name, and by prefix (dot included).  a change looks up its
+    // own name, then each of its dotted prefixes, so the cost follows the
+    // name's depth, not the number of subscribers.
+    using subscribers_t = std::unordered_map<std::string, std::vector<Callable>>;
+    subscribers_t exactSubscribers_{};
+    subscribers_t prefixSubscribers_{};
+
+    void notifySubscribers(const std::string& name, const String& itemName, const Variant& value);
+    static void notifyList(subscribers_t& subscribers, const std::string& key, const String& itemName, const Variant& value);
+
+    ConfigItem* proxyFor(const SettingsTable::slot_t slot);
+    ConfigItem* takeDetached(const SettingsTable::slot_t slot);
+    Variant valueOf(const SettingsTable::slot_t slot) const;
+    void emitApplied(const std::vector<SettingsTable::slot_t>& slots, const bool touch);
+    void readSlot(const SettingsTable::slot_t slot, bool& value) const { value = table_.getBool(slot); }
+    void readSlot(const SettingsTable::slot_t slot, int64_t& value) const { value = table_.getInt(slot); }
+    void readSlot(const SettingsTable::slot_t slot, double& value) const { value = table_.getFloat(slot); }
+    void readSlot(const SettingsTable::slot_t slot, String& value) const { value = translate(table_.getString(slot)); }
     void remove(const std::string & settingName);
 };
 
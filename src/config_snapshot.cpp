@@ -0,0 +1,61 @@
+#include "config_snapshot.h"
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+ConfigSnapshotCell::~ConfigSnapshotCell()
+{
+    delete current_.load(std::memory_order_relaxed);
+}
+
+void ConfigSnapshotCell::publish(std::unique_ptr<const ConfigSnapshot> snapshot)
+{
+    auto version = snapshot->version();
+    auto previous = current_.exchange(snapshot.release());
+    version_.store(version);
+    if (previous != nullptr)
+        retired_.emplace_back(previous);
+    reclaim();
+}
+
+void ConfigSnapshotCell::reclaim()
+{
+    // a reader pinned at some version can only have loaded that one or
+    // a later one, so anything older than the oldest pin is unreachable
+    auto oldest = ~uint64_t(0);
+    for (auto& reader : readers_) {
+        auto version = reader.load();
+        if (version != 0)
+            oldest = std::min(oldest, version);
+    }
+    retired_.erase(std::remove_if(retired_.begin(), retired_.end(),
+        [oldest](const std::unique_ptr<const ConfigSnapshot>& snapshot) { return snapshot->version() < oldest; }),
+        retired_.end());
+}
+
+ConfigSnapshotPin::ConfigSnapshotPin(const ConfigSnapshotCell& cell)
+    : cell_(cell)
+{
+    // the version is read before the pointer it protects, and published
+    // after it, so the pin is never newer than what get() returns
+    auto version = std::max<uint64_t>(cell.version_.load(), 1);
+    auto start = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    for (;;) {
+        for (size_t i = 0; i < ConfigSnapshotCell::READER_SLOTS; i++) {
+            slot_ = (start + i) % ConfigSnapshotCell::READER_SLOTS;
+            uint64_t expected = 0;
+            if (cell.readers_[slot_].compare_exchange_strong(expected, version)) {
+                // pairs with the exchange in publish, so either reclaim
+                // sees this pin or the loads below see the new snapshot
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                return;
+            }
+        }
+        std::this_thread::yield();
+    }
+}
+
+ConfigSnapshotPin::~ConfigSnapshotPin()
+{
+    cell_.readers_[slot_].store(0, std::memory_order_release);
+}
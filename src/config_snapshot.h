@@ -0,0 +1,88 @@
+#pragma once
+#ifndef __SRG_CONFIG_SNAPSHOT_HEADER__
+#define __SRG_CONFIG_SNAPSHOT_HEADER__
+
+#include "config_table.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+///
+/// A frozen copy of every setting in a ConfigStore, taken each time
+/// changes get applied.  Nothing in here ever changes after it is
+/// published, so any thread can read it without locking.  The version
+/// goes up by one with every snapshot, so a worker can tell when to
+/// look again.
+///
+class ConfigSnapshot
+{
+public:
+    ConfigSnapshot(const uint64_t version, const SettingsTable& system, const SettingsTable& gameplay)
+        : version_(version), system_(system), gameplay_(gameplay) {}
+
+    uint64_t version() const { return version_; }
+    const SettingsTable& system() const { return system_; }
+    const SettingsTable& gameplay() const { return gameplay_; }
+
+private:
+    const uint64_t version_;
+    const SettingsTable system_;
+    const SettingsTable gameplay_;
+};
+
+///
+/// Where the current snapshot gets published.  Reading it is a single
+/// acquire load.  Replaced snapshots are kept until no reader can still
+/// be looking at one: threads other than the publisher hold a
+/// ConfigSnapshotPin while they read, which records the oldest version
+/// they might see, and only older ones get freed.
+///
+class ConfigSnapshotCell
+{
+public:
+    ConfigSnapshotCell() = default;
+    ConfigSnapshotCell(const ConfigSnapshotCell&) = delete;
+    ConfigSnapshotCell& operator=(const ConfigSnapshotCell&) = delete;
+    // every pin has to be gone by now
+    ~ConfigSnapshotCell();
+
+    const ConfigSnapshot* load() const { return current_.load(std::memory_order_acquire); }
+    // from one thread only.  frees whatever no pin can reach anymore.
+    void publish(std::unique_ptr<const ConfigSnapshot> snapshot);
+
+private:
+    friend class ConfigSnapshotPin;
+    static constexpr size_t READER_SLOTS = 64;
+
+    std::atomic<const ConfigSnapshot*> current_{ nullptr };
+    std::atomic<uint64_t> version_{};
+    // the version each pinned reader started at, 0 for a free slot
+    mutable std::atomic<uint64_t> readers_[READER_SLOTS]{};
+    std::vector<std::unique_ptr<const ConfigSnapshot>> retired_{};
+
+    void reclaim();
+};
+
+///
+/// Keeps the snapshots a thread reads from a cell alive.  Pointers got
+/// from get() while the pin is held stay valid until it goes.  Pinning
+/// takes one of a fixed number of slots, so hold it around a batch of
+/// reads rather than for good.
+///
+class ConfigSnapshotPin
+{
+public:
+    explicit ConfigSnapshotPin(const ConfigSnapshotCell& cell);
+    ~ConfigSnapshotPin();
+    ConfigSnapshotPin(const ConfigSnapshotPin&) = delete;
+    ConfigSnapshotPin& operator=(const ConfigSnapshotPin&) = delete;
+
+    const ConfigSnapshot* get() const { return cell_.load(); }
+    const ConfigSnapshot* operator->() const { return get(); }
+
+private:
+    const ConfigSnapshotCell& cell_;
+    size_t slot_{};
+};
+
+#endif /// __SRG_CONFIG_SNAPSHOT_HEADER__
@@ -1,13 +1,20 @@
 #include "config_store.h"
 #include "common_utils.h"
+#include "path_cache.h"
 #include <godot_cpp/classes/dir_access.hpp>
+#include <godot_cpp/classes/engine.hpp>
 #include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/scene_tree.hpp>
+#include <godot_cpp/classes/time.hpp>
 
 void ConfigStore::_bind_methods()
 {
     DECLARE_PROPERTY(ConfigStore, ActivePlayer, newPlayer, Variant::STRING);
     DECLARE_PROPERTY(ConfigStore, AutoLoad, newState, Variant::BOOL);
     DECLARE_PROPERTY(ConfigStore, AutoSave, newState, Variant::BOOL);
+    DECLARE_PROPERTY(ConfigStore, PerSettingSignals, state, Variant::BOOL);
+    DECLARE_PROPERTY(ConfigStore, CoalesceChanges, state, Variant::BOOL);
+    DECLARE_PROPERTY(ConfigStore, SaveQuietPeriod, seconds, Variant::FLOAT);
     DECLARE_RESOURCE_PROPERTY(ConfigStore, RuntimeSource, source, FileLocator);
     DECLARE_RESOURCE_PROPERTY(ConfigStore, DefaultSource, source, FileLocator);
 
@@ -19,28 +26,41 @@ void ConfigStore::_bind_methods()
     ClassDB::bind_method(D_METHOD("applyChanges"), &ConfigStore::applyChanges);
     ClassDB::bind_method(D_METHOD("undoPendingChanges"), &ConfigStore::undoPendingChanges);
 
+    ClassDB::bind_method(D_METHOD("getSnapshotVersion"), &ConfigStore::getSnapshotVersion);
+    ClassDB::bind_method(D_METHOD("flush"), &ConfigStore::flush);
+    ClassDB::bind_method(D_METHOD("_poll"), &ConfigStore::_poll);
     ClassDB::bind_method(D_METHOD("save"), &ConfigStore::save);
     ClassDB::bind_method(D_METHOD("load"), &ConfigStore::load);
     ClassDB::bind_method(D_METHOD("resetToDefaults"), &ConfigStore::resetToDefaults);
 
+    ClassDB::bind_method(D_METHOD("subscribe", "key", "callback"), &ConfigStore::subscribe);
+    ClassDB::bind_method(D_METHOD("unsubscribe", "key", "callback"), &ConfigStore::unsubscribe);
+
     ClassDB::bind_method(D_METHOD("getSystemSettings"), &ConfigStore::getSystemSettings);
     ClassDB::bind_method(D_METHOD("getGameplaySettings"), &ConfigStore::getGameplaySettings);
 
     ClassDB::bind_method(D_METHOD("onApplySetting", "setting_name", "setting"), &ConfigStore::onApplySetting);
+    ClassDB::bind_method(D_METHOD("onSettingsApplied", "names", "values"), &ConfigStore::onSettingsApplied);
 
     ADD_SIGNAL(MethodInfo("apply_setting", PropertyInfo(Variant::STRING, "setting_name"),
         PropertyInfo(Variant::OBJECT, "setting", PROPERTY_HINT_OBJECT_ID, "ConfigItem")));
+    ADD_SIGNAL(MethodInfo("settings_applied", PropertyInfo(Variant::PACKED_STRING_ARRAY, "names"),
+        PropertyInfo(Variant::ARRAY, "values")));
 }
 
 ConfigStore::ConfigStore() 
 {
     systemSettings_->connect("apply_setting", Callable(this, "onApplySetting"));
     gameplaySettings_->connect("apply_setting", Callable(this, "onApplySetting"));
+    systemSettings_->connect("settings_applied", Callable(this, "onSettingsApplied"));
+    gameplaySettings_->connect("settings_applied", Callable(this, "onSettingsApplied"));
+    publishSnapshot();
 }
 
 ConfigStore::~ConfigStore()
 {
-    if (autoSave_)
+    stopPolling();
+    if (autoSave_ || savePending_)
         save();
 
     memdelete(systemSettings_);
@@ -52,6 +72,32 @@ void ConfigStore::onApplySetting(String setting_name, ConfigItem* setting)
     emit_signal("apply_setting", setting_name, setting);
 }
 
+void ConfigStore::onSettingsApplied(PackedStringArray names, Array values)
+{
+    // every apply on either collection comes through here, however it
+    // was started, so workers see what the main thread just applied
+    publishSnapshot();
+    emit_signal("settings_applied", names, values);
+}
+
+void ConfigStore::setPerSettingSignals(const bool state)
+{
+    systemSettings_->setPerSettingSignals(state);
+    gameplaySettings_->setPerSettingSignals(state);
+}
+
+void ConfigStore::subscribe(String key, Callable callback)
+{
+    systemSettings_->subscribe(key, callback);
+    gameplaySettings_->subscribe(key, callback);
+}
+
+void ConfigStore::unsubscribe(String key, Callable callback)
+{
+    systemSettings_->unsubscribe(key, callback);
+    gameplaySettings_->unsubscribe(key, callback);
+}
+
 void ConfigStore::resetToDefaults()
 {
     // default source must exist, or this is pointless
@@ -94,9 +140,93 @@ bool ConfigStore::hasChanges() const
 
 void ConfigStore::applyChanges()
 {
+    // no tree to wait on, like in the editor.  just do it now.
+    if (coalesceChanges_ && startPolling()) {
+        applyPending_ = true;
+        return;
+    }
+
+    applyNow();
+    save();
+}
+
+bool ConfigStore::applyNow()
+{
+    applyPending_ = false;
+    bool changed = hasChanges();
     systemSettings_->applyChanges();
     gameplaySettings_->applyChanges();
-    save();
+    return changed;
+}
+
+void ConfigStore::publishSnapshot()
+{
+    snapshots_.publish(std::make_unique<const ConfigSnapshot>(++snapshotVersion_,
+        systemSettings_->getTable(), gameplaySettings_->getTable()));
+}
+
+void ConfigStore::setCoalesceChanges(const bool state)
+{
+    if (coalesceChanges_ && !state)
+        flush();
+    coalesceChanges_ = state;
+}
+
+void ConfigStore::flush()
+{
+    if (applyPending_)
+        applyNow();
+    if (savePending_) {
+        savePending_ = false;
+        save();
+    }
+    stopPolling();
+}
+
+void ConfigStore::_poll()
+{
+    auto now = Time::get_singleton()->get_ticks_msec();
+
+    // any number of applies this frame end up as this one
+    // an apply that found nothing to do has nothing to save either
+    if (applyPending_) {
+        if (applyNow()) {
+            savePending_ = true;
+            lastApplyMsec_ = now;
+        }
+    }
+    else if (savePending_ && static_cast<double>(now - lastApplyMsec_) >= saveQuietPeriod_ * 1000.0) {
+        savePending_ = false;
+        save();
+    }
+
+    if (!applyPending_ && !savePending_)
+        stopPolling();
+}
+
+bool ConfigStore::startPolling()
+{
+    if (polling_)
+        return true;
+
+    auto tree = Object::cast_to<SceneTree>(Engine::get_singleton()->get_main_loop());
+    if (tree == nullptr)
+        return false;
+
+    tree->connect("process_frame", Callable(this, "_poll"));
+    polling_ = true;
+    return true;
+}
+
+void ConfigStore::stopPolling()
+{
+    if (!polling_)
+        return;
+
+    auto tree = Object::cast_to<SceneTree>(Engine::get_singleton()->get_main_loop());
+    if (tree != nullptr)
+        tree->disconnect("process_frame", Callable(this, "_poll"));
+    polling_ = false;
 }
 void ConfigStore::undoPendingChanges()
 {
@@ -106,7 +236,7 @@ void ConfigStore::undoPendingChanges()
 
 void ConfigStore::loadActual(const String filename)
 {
-    if (!FileAccess::file_exists(filename))
+    if (!PathCache::fileExists(filename))
         return;
 
     auto fileContents = std::string(FileAccess::get_file_as_string(filename).utf8().get_data());
@@ -115,6 +245,7 @@ void ConfigStore::loadActual(const String filename)
     activePlayer_ = String(std::string(j["player"]).data());
     from_json(j["system"], systemSettings_);
     from_json(j["gameplay"], gameplaySettings_);
+    publishSnapshot();
 }
 
 void ConfigStore::load()
@@ -127,7 +258,7 @@ void ConfigStore::load()
     auto defaultFile = defaultSource_->getResolvedPath();
 
     // remmember if we have to write this out afterwards
-    bool saveAfter = !FileAccess::file_exists(runtimeFile);
+    bool saveAfter = !PathCache::fileExists(runtimeFile);
     String fileToUse = saveAfter ? defaultFile : runtimeFile;
 
     loadActual(fileToUse);
@@ -160,6 +291,7 @@ void ConfigStore::saveActual(const String filename)
         auto file = FileAccess::open(filename, FileAccess::WRITE);
         file->store_string(data);
         file->close();
+        PathCache::noteFile(filename, true);
     }
     catch (...)
     {
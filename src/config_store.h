@@ -3,6 +3,7 @@
 #define __SRG_CONFIGURATION_STORAGE__
 
 #include "config_settings.h"
+#include "config_snapshot.h"
 #include "files_source.h"
 #include "json_helpers.h"
 
@@ -31,6 +32,34 @@ public:
     bool getAutoSave() const { return autoSave_; }
     void setAutoSave(const bool newState) { autoSave_ = newState; }
 
+    // passed on to both setting collections
+    bool getPerSettingSignals() const { return systemSettings_->getPerSettingSignals(); }
+    void setPerSettingSignals(const bool state);
+
+    // on both setting collections.  see ConfigItems::subscribe
+    void subscribe(String key, Callable callback);
+    void unsubscribe(String key, Callable callback);
+
+    // when set, applyChanges only flags the collections.  the apply runs
+    // once, at the end of the frame, and the file gets saved once changes
+    // have stopped for SaveQuietPeriod seconds.
+    bool getCoalesceChanges() const { return coalesceChanges_; }
+    void setCoalesceChanges(const bool state);
+    double getSaveQuietPeriod() const { return saveQuietPeriod_; }
+    void setSaveQuietPeriod(const double seconds) { saveQuietPeriod_ = seconds > 0.0 ? seconds : 0.0; }
+
+    // runs a pending apply and save right now
+    void flush();
+    void _poll();
+
+    // the values as of the last apply or load.  the main thread swaps in
+    // a new one, it never edits one.  on the main thread a snapshot lasts
+    // until the next apply; other threads read through a pin:
+    //     ConfigSnapshotPin pin(store->snapshots());
+    const ConfigSnapshot* snapshot() const { return snapshots_.load(); }
+    const ConfigSnapshotCell& snapshots() const { return snapshots_; }
+    int64_t getSnapshotVersion() const { return static_cast<int64_t>(snapshot()->version()); }
+
     void resetToDefaults();
 
     void mark();
@@ -46,6 +75,7 @@ public:
 
 protected:
     void onApplySetting(String setting_name, ConfigItem* setting);
+    void onSettingsApplied(PackedStringArray names, Array values);
 
 private:
     String activePlayer_{};
@@ -58,6 +88,22 @@ private:
     Ref<FileLocator> runtimeSource_{};
     Ref<FileLocator> defaultSource_{};
 
+    bool coalesceChanges_{};
+    double saveQuietPeriod_{ 1.0 };
+    bool applyPending_{};
+    bool savePending_{};
+    uint64_t lastApplyMsec_{};
+    bool polling_{};
+
+    ConfigSnapshotCell snapshots_{};
+    uint64_t snapshotVersion_{};
+
+    void publishSnapshot();
+    bool startPolling();
+    void stopPolling();
+    // true if anything had changed
+    bool applyNow();
+
     void saveActual(const String filename);
     void loadActual(const String filename);
 };
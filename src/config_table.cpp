@@ -0,0 +1,387 @@
+#include "config_table.h"
+#include "config_journal.h"
+#include <algorithm>
+#include <cassert>
+
+SettingsTable::SettingsTable(const SettingsTable& other)
+{
+    *this = other;
+}
+
+SettingsTable& SettingsTable::operator=(const SettingsTable& other)
+{
+    if (this == &other)
+        return *this;
+
+    names_ = other.names_;
+    hashes_ = other.hashes_;
+    types_ = other.types_;
+    rows_ = other.rows_;
+    flags_ = other.flags_;
+    buckets_ = other.buckets_;
+    dirty_ = other.dirty_;
+    changedCount_ = other.changedCount_;
+    bools_ = other.bools_;
+    ints_ = other.ints_;
+    floats_ = other.floats_;
+    strings_ = other.strings_;
+    journal_ = nullptr;
+
+    index_.clear();
+    for (auto& item : other.index_) {
+        index_.emplace(names_[item.second], item.second);
+    }
+    return *this;
+}
+
+void SettingsTable::clear()
+{
+    names_.clear();
+    hashes_.clear();
+    types_.clear();
+    rows_.clear();
+    flags_.clear();
+    index_.clear();
+    buckets_.clear();
+    dirty_.clear();
+    changedCount_ = 0;
+    bools_ = Column<uint8_t>();
+    ints_ = Column<int64_t>();
+    floats_ = Column<double>();
+    strings_ = Column<std::string>();
+}
+
+SettingsTable::slot_t SettingsTable::add(const std::string& name, const ValueType type)
+{
+    auto existing = find(name);
+    if (existing != npos)
+        return existing;
+
+    uint32_t row = 0;
+    switch (type) {
+    case T_BOOL: row = addRow(bools_); break;
+    case T_INT: row = addRow(ints_); break;
+    case T_FLOAT: row = addRow(floats_); break;
+    case T_STRING: row = addRow(strings_); break;
+    default: break;
+    }
+
+    auto slot = static_cast<slot_t>(names_.size());
+    names_.push_back(name);
+    hashes_.push_back(hashName(name));
+    types_.push_back(type);
+    rows_.push_back(row);
+    flags_.push_back(F_LIVE | F_FRESH);
+    index_.emplace(names_.back(), slot);
+
+    // keep the load under a half, tombstones included
+    if ((names_.size() * 2) > buckets_.size())
+        rebuildBuckets(buckets_.empty() ? 16 : buckets_.size() * 2);
+    else
+        insertBucket(slot);
+    return slot;
+}
+
+SettingsTable::slot_t SettingsTable::find(std::string_view name) const
+{
+    if (buckets_.empty())
+        return npos;
+
+    auto hash = hashName(name);
+    auto mask = buckets_.size() - 1;
+    for (auto i = static_cast<size_t>(hash) & mask; ; i = (i + 1) & mask) {
+        auto slot = buckets_[i];
+        if (slot == npos)
+            return npos;
+        if (hashes_[slot] == hash && (flags_[slot] & F_LIVE) && names_[slot] == name)
+            return slot;
+    }
+}
+
+bool SettingsTable::getBool(std::string_view name, const bool defaultValue) const
+{
+    auto slot = find(name);
+    return (slot != npos && typeOf(slot) == T_BOOL) ? getBool(slot) : defaultValue;
+}
+
+int64_t SettingsTable::getInt(std::string_view name, const int64_t defaultValue) const
+{
+    auto slot = find(name);
+    return (slot != npos && typeOf(slot) == T_INT) ? getInt(slot) : defaultValue;
+}
+
+double SettingsTable::getFloat(std::string_view name, const double defaultValue) const
+{
+    auto slot = find(name);
+    return (slot != npos && typeOf(slot) == T_FLOAT) ? getFloat(slot) : defaultValue;
+}
+
+std::string SettingsTable::getString(std::string_view name, const std::string& defaultValue) const
+{
+    auto slot = find(name);
+    return (slot != npos && typeOf(slot) == T_STRING) ? getString(slot) : defaultValue;
+}
+
+uint64_t SettingsTable::hashName(std::string_view name)
+{
+    // fnv-1a.  names are short, so nothing fancier pays off
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (auto c : name) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+void SettingsTable::insertBucket(const slot_t slot)
+{
+    auto mask = buckets_.size() - 1;
+    auto i = static_cast<size_t>(hashes_[slot]) & mask;
+    while (buckets_[i] != npos) {
+        i = (i + 1) & mask;
+    }
+    buckets_[i] = slot;
+}
+
+void SettingsTable::rebuildBuckets(const size_t bucketCount)
+{
+    buckets_.assign(bucketCount, npos);
+    for (slot_t slot = 0; slot < flags_.size(); slot++) {
+        if (flags_[slot] & F_LIVE)
+            insertBucket(slot);
+    }
+}
+
+void SettingsTable::remove(const std::string& name)
+{
+    // removals are rare, so the slot and its row are just retired
+    auto it = index_.find(name);
+    if (it == index_.end())
+        return;
+
+    if (hasChanged(it->second))
+        changedCount_--;
+    flags_[it->second] = 0;
+    index_.erase(it);
+}
+
+void SettingsTable::forEach(const std::function<void(const std::string& name, const slot_t slot)>& fn) const
+{
+    for (auto& item : index_) {
+        fn(names_[item.second], item.second);
+    }
+}
+
+void SettingsTable::copyValue(const slot_t slot, const SettingsTable& source, const slot_t sourceSlot)
+{
+    // an equal value would still reset the change flag, so skip it
+    if (typeOf(slot) != source.typeOf(sourceSlot) || sameValue(slot, source, sourceSlot))
+        return;
+
+    switch (typeOf(slot)) {
+    case T_BOOL: setBool(slot, source.getBool(sourceSlot)); break;
+    case T_INT: setInt(slot, source.getInt(sourceSlot)); break;
+    case T_FLOAT: setFloat(slot, source.getFloat(sourceSlot)); break;
+    case T_STRING: setString(slot, source.getString(sourceSlot)); break;
+    default: break;
+    }
+}
+
+void SettingsTable::exchange(const slot_t slot, Value& value)
+{
+    if (!isLive(slot) || typeOf(slot) != value.type)
+        return;
+
+    switch (typeOf(slot)) {
+    case T_BOOL: {
+        uint8_t state = value.number != 0 ? 1 : 0;
+        exchangeRow(bools_, slot, state);
+        value.number = state;
+        break;
+    }
+    case T_INT: exchangeRow(ints_, slot, value.number); break;
+    case T_FLOAT: exchangeRow(floats_, slot, value.real); break;
+    case T_STRING: exchangeRow(strings_, slot, value.text); break;
+    default: break;
+    }
+}
+
+void SettingsTable::journalOld(const slot_t slot, uint8_t&& value)
+{
+    Value old;
+    old.type = T_BOOL;
+    old.number = value;
+    journal_->record(slot, std::move(old));
+}
+
+void SettingsTable::journalOld(const slot_t slot, int64_t&& value)
+{
+    Value old;
+    old.type = T_INT;
+    old.number = value;
+    journal_->record(slot, std::move(old));
+}
+
+void SettingsTable::journalOld(const slot_t slot, double&& value)
+{
+    Value old;
+    old.type = T_FLOAT;
+    old.real = value;
+    journal_->record(slot, std::move(old));
+}
+
+void SettingsTable::journalOld(const slot_t slot, std::string&& value)
+{
+    Value old;
+    old.type = T_STRING;
+    old.text = std::move(value);
+    journal_->record(slot, std::move(old));
+}
+
+bool SettingsTable::sameValue(const slot_t slot, const SettingsTable& source, const slot_t sourceSlot) const
+{
+    if (typeOf(slot) != source.typeOf(sourceSlot))
+        return false;
+
+    switch (typeOf(slot)) {
+    case T_BOOL: return getBool(slot) == source.getBool(sourceSlot);
+    case T_INT: return getInt(slot) == source.getInt(sourceSlot);
+    case T_FLOAT: return getFloat(slot) == source.getFloat(sourceSlot);
+    case T_STRING: return getString(slot) == source.getString(sourceSlot);
+    default: return true;
+    }
+}
+
+void SettingsTable::mark(const slot_t slot)
+{
+    // what was undone before the mark isn't there to be redone after it
+    if (journal_ != nullptr)
+        journal_->dropRedo();
+
+    auto row = rows_[slot];
+    switch (typeOf(slot)) {
+    case T_BOOL: markRow(bools_, row); break;
+    case T_INT: markRow(ints_, row); break;
+    case T_FLOAT: markRow(floats_, row); break;
+    case T_STRING: markRow(strings_, row); break;
+    default: break;
+    }
+    setChanged(slot, false);
+    setFlag(slot, F_MARKED, true);
+}
+
+void SettingsTable::restore(const slot_t slot)
+{
+    if (!hasChanged(slot))
+        return;
+
+    // a restore is a change of value like any other, so undo can take
+    // it back; the value it replaces goes to the journal
+    auto row = rows_[slot];
+    auto journaled = journal_ != nullptr && (flags_[slot] & F_FRESH) == 0;
+    switch (typeOf(slot)) {
+    case T_BOOL: restoreRow(bools_, row, journaled ? slot : npos); break;
+    case T_INT: restoreRow(ints_, row, journaled ? slot : npos); break;
+    case T_FLOAT: restoreRow(floats_, row, journaled ? slot : npos); break;
+    case T_STRING: restoreRow(strings_, row, journaled ? slot : npos); break;
+    default: break;
+    }
+    setChanged(slot, false);
+    setFlag(slot, F_MARKED, false);
+}
+
+void SettingsTable::touch(const slot_t slot)
+{
+    // an unchanged slot keeps its mark, like restore() does
+    if (!hasChanged(slot))
+        return;
+
+    setChanged(slot, false);
+    setFlag(slot, F_MARKED, false);
+}
+
+void SettingsTable::markAll()
+{
+    for (slot_t slot = 0; slot < flags_.size(); slot++) {
+        if (flags_[slot] & F_LIVE)
+            mark(slot);
+    }
+    drainDirty([](const slot_t) {});
+}
+
+void SettingsTable::restoreAll()
+{
+    // undone in one step, the way it was done
+    if (journal_ != nullptr)
+        journal_->beginGroup();
+    drainDirty([this](const slot_t slot) { restore(slot); });
+    if (journal_ != nullptr)
+        journal_->endGroup();
+}
+
+void SettingsTable::touchAll()
+{
+    drainDirty([this](const slot_t slot) { touch(slot); });
+}
+
+bool SettingsTable::anyChanged() const
+{
+#ifdef SRG_VERIFY_SETTINGS
+    verifyDirty();
+#endif
+    return changedCount_ != 0;
+}
+
+void SettingsTable::changedSlots(std::vector<slot_t>& slots) const
+{
+    slots.clear();
+    for (auto slot : dirty_) {
+        if ((flags_[slot] & F_LIVE) && hasChanged(slot))
+            slots.push_back(slot);
+    }
+    std::sort(slots.begin(), slots.end(), [this](const slot_t a, const slot_t b) { return names_[a] < names_[b]; });
+}
+
+void SettingsTable::pruneDirty()
+{
+    size_t kept = 0;
+    for (auto slot : dirty_) {
+        if ((flags_[slot] & F_LIVE) && hasChanged(slot))
+            dirty_[kept++] = slot;
+        else
+            setFlag(slot, F_LISTED, false);
+    }
+    dirty_.resize(kept);
+
+#ifdef SRG_VERIFY_SETTINGS
+    verifyDirty();
+#endif
+}
+
+void SettingsTable::drainDirty(const std::function<void(const slot_t slot)>& fn)
+{
+    for (auto slot : dirty_) {
+        if ((flags_[slot] & F_LIVE) && hasChanged(slot))
+            fn(slot);
+        setFlag(slot, F_LISTED, false);
+    }
+    dirty_.clear();
+
+#ifdef SRG_VERIFY_SETTINGS
+    verifyDirty();
+#endif
+}
+
+void SettingsTable::verifyDirty() const
+{
+    // the slow way round, to catch a set path that skipped setChanged
+    size_t changed = 0;
+    for (slot_t slot = 0; slot < flags_.size(); slot++) {
+        if ((flags_[slot] & F_LIVE) && hasChanged(slot)) {
+            assert((flags_[slot] & F_LISTED) != 0);
+            changed++;
+        }
+    }
+    assert(changed == changedCount_);
+    (void)changed;
+}
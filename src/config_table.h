@@ -0,0 +1,222 @@
+#pragma once
+#ifndef __SRG_CONFIG_TABLE_HEADER__
+#define __SRG_CONFIG_TABLE_HEADER__
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class SettingsJournal;
+
+///
+/// Flat storage for a set of named settings.  Each value lives in a
+/// column for its type, next to the value it had before the last change,
+/// and the change flags sit in a column of their own.  A setting is just
+/// a slot number, so thousands of them cost a few vectors instead of an
+/// object apiece, and a pass over every flag is a pass over one array.
+/// The undo rules are the same ones undoable_t follows.
+/// Names are stored once, and looked up through an open addressing
+/// hash index; the sorted index is only walked when iterating.
+/// Slots that change go on a dirty list, so asking whether anything
+/// changed is a counter check, and restore/touch only visit those.
+/// Build with SRG_VERIFY_SETTINGS to check the list against a full scan.
+///
+class SettingsTable
+{
+public:
+    using slot_t = uint32_t;
+    static constexpr slot_t npos = ~slot_t(0);
+
+    // mirrors ConfigItem::ConfigValueType
+    enum ValueType : uint8_t { T_BLANK = 0, T_BOOL, T_INT, T_FLOAT, T_STRING };
+
+    // one value of any type, for the journal.  bools go in number.
+    struct Value {
+        ValueType type{ T_BLANK };
+        int64_t number{};
+        double real{};
+        std::string text{};
+    };
+
+    SettingsTable() = default;
+    // the sorted index points into names_, so copies rebuild theirs
+    SettingsTable(const SettingsTable& other);
+    SettingsTable& operator=(const SettingsTable& other);
+    SettingsTable(SettingsTable&&) = default;
+    SettingsTable& operator=(SettingsTable&&) = default;
+
+    void clear();
+    size_t size() const { return index_.size(); }
+
+    // returns the existing slot if the name is taken, whatever its type
+    slot_t add(const std::string& name, const ValueType type);
+    slot_t find(std::string_view name) const;
+    void remove(const std::string& name);
+
+    const std::string& nameOf(const slot_t slot) const { return names_[slot]; }
+    ValueType typeOf(const slot_t slot) const { return static_cast<ValueType>(types_[slot]); }
+
+    // live settings, in name order
+    void forEach(const std::function<void(const std::string& name, const slot_t slot)>& fn) const;
+
+    bool getBool(const slot_t slot) const { return bools_.current[rows_[slot]] != 0; }
+    int64_t getInt(const slot_t slot) const { return ints_.current[rows_[slot]]; }
+    double getFloat(const slot_t slot) const { return floats_.current[rows_[slot]]; }
+    const std::string& getString(const slot_t slot) const { return strings_.current[rows_[slot]]; }
+
+    // by name, defaultValue if missing or of another type
+    bool getBool(std::string_view name, const bool defaultValue) const;
+    int64_t getInt(std::string_view name, const int64_t defaultValue) const;
+    double getFloat(std::string_view name, const double defaultValue) const;
+    std::string getString(std::string_view name, const std::string& defaultValue) const;
+
+    void setBool(const slot_t slot, const bool value) { assign(bools_, slot, static_cast<uint8_t>(value ? 1 : 0)); }
+    void setInt(const slot_t slot, const int64_t value) { assign(ints_, slot, value); }
+    void setFloat(const slot_t slot, const double value) { assign(floats_, slot, value); }
+    void setString(const slot_t slot, const std::string& value) { assign(strings_, slot, value); }
+
+    // every change of value gets handed to the journal, old value first.
+    // not carried over to copies.
+    void setJournal(SettingsJournal* journal) { journal_ = journal; }
+    // swaps the slot's value with value, as if it had been set.  this is
+    // how the journal steps back and forth without copying.
+    void exchange(const slot_t slot, Value& value);
+    bool isLive(const slot_t slot) const { return slot < flags_.size() && (flags_[slot] & F_LIVE) != 0; }
+
+    // copies the value over, only if both slots hold the same type
+    void copyValue(const slot_t slot, const SettingsTable& source, const slot_t sourceSlot);
+    bool sameValue(const slot_t slot, const SettingsTable& source, const slot_t sourceSlot) const;
+
+    void mark(const slot_t slot);
+    void restore(const slot_t slot);
+    void touch(const slot_t slot);
+    bool hasChanged(const slot_t slot) const { return (flags_[slot] & F_CHANGED) != 0; }
+
+    // markAll still visits every slot, the rest only the changed ones
+    void markAll();
+    void restoreAll();
+    void touchAll();
+    bool anyChanged() const;
+    size_t changedCount() const { return changedCount_; }
+    // changed slots, in name order
+    void changedSlots(std::vector<slot_t>& slots) const;
+    // takes the slots that aren't changed anymore off the dirty list.
+    // call after touching a batch one by one, so it doesn't keep growing.
+    void pruneDirty();
+
+private:
+    // F_LISTED: the slot is on dirty_, changed or not by now.
+    // F_FRESH: not assigned yet, so there's nothing worth journaling.
+    enum Flags : uint8_t { F_CHANGED = 1, F_MARKED = 2, F_LIVE = 4, F_LISTED = 8, F_FRESH = 16 };
+
+    template<typename T>
+    struct Column {
+        std::vector<T> current{};
+        std::vector<T> previous{};
+    };
+
+    // per slot.  names never move, so the indices can point into them
+    std::deque<std::string> names_{};
+    std::vector<uint64_t> hashes_{};
+    std::vector<uint8_t> types_{};
+    std::vector<uint32_t> rows_{};
+    std::vector<uint8_t> flags_{};
+    std::map<std::string_view, slot_t> index_{};
+    // slot numbers, npos for empty.  retired slots stay in as tombstones
+    // until the next rebuild.  always a power of two in size.
+    std::vector<slot_t> buckets_{};
+    std::vector<slot_t> dirty_{};
+    size_t changedCount_{};
+    SettingsJournal* journal_{};
+
+    static uint64_t hashName(std::string_view name);
+    void insertBucket(const slot_t slot);
+    void rebuildBuckets(const size_t bucketCount);
+
+    // per type, indexed by row
+    Column<uint8_t> bools_{};
+    Column<int64_t> ints_{};
+    Column<double> floats_{};
+    Column<std::string> strings_{};
+
+    template<typename T>
+    void assign(Column<T>& column, const slot_t slot, const T& value)
+    {
+        auto row = rows_[slot];
+        if ((flags_[slot] & F_MARKED) == 0)
+            column.previous[row] = column.current[row];
+        // the old value is dead after this, so the journal can have it
+        if (journal_ != nullptr && (flags_[slot] & F_FRESH) == 0 && !(column.current[row] == value))
+            journalOld(slot, std::move(column.current[row]));
+        setFlag(slot, F_FRESH, false);
+        column.current[row] = value;
+        setChanged(slot, column.current[row] != column.previous[row]);
+    }
+
+    template<typename T>
+    void exchangeRow(Column<T>& column, const slot_t slot, T& value)
+    {
+        auto row = rows_[slot];
+        if ((flags_[slot] & F_MARKED) == 0)
+            column.previous[row] = column.current[row];
+        std::swap(column.current[row], value);
+        setChanged(slot, column.current[row] != column.previous[row]);
+    }
+
+    void journalOld(const slot_t slot, uint8_t&& value);
+    void journalOld(const slot_t slot, int64_t&& value);
+    void journalOld(const slot_t slot, double&& value);
+    void journalOld(const slot_t slot, std::string&& value);
+
+    template<typename T>
+    static uint32_t addRow(Column<T>& column)
+    {
+        column.current.emplace_back();
+        column.previous.emplace_back();
+        return static_cast<uint32_t>(column.current.size() - 1);
+    }
+
+    // journals the value being replaced unless slot is npos
+    template<typename T>
+    void restoreRow(Column<T>& column, const uint32_t row, const slot_t slot)
+    {
+        if (slot != npos)
+            journalOld(slot, std::move(column.current[row]));
+        column.current[row] = column.previous[row];
+    }
+    template<typename T>
+    static void markRow(Column<T>& column, const uint32_t row) { column.previous[row] = column.current[row]; }
+
+    void setFlag(const slot_t slot, const uint8_t flag, const bool state)
+    {
+        flags_[slot] = state ? (flags_[slot] | flag) : (flags_[slot] & ~flag);
+    }
+
+    void setChanged(const slot_t slot, const bool state)
+    {
+        if (hasChanged(slot) == state)
+            return;
+
+        setFlag(slot, F_CHANGED, state);
+        if (!state) {
+            changedCount_--;
+            return;
+        }
+
+        changedCount_++;
+        if ((flags_[slot] & F_LISTED) == 0) {
+            setFlag(slot, F_LISTED, true);
+            dirty_.push_back(slot);
+        }
+    }
+
+    // empties dirty_, calling fn on the live slots still changed
+    void drainDirty(const std::function<void(const slot_t slot)>& fn);
+    void verifyDirty() const;
+};
+
+#endif /// __SRG_CONFIG_TABLE_HEADER__
@@ -0,0 +1,160 @@
+#include "content_hash.h"
+#include <godot_cpp/classes/file_access.hpp>
+#include <cstring>
+#include <memory>
+
+namespace {
+    const uint64_t PRIME1 = 11400714785074694791ULL;
+    const uint64_t PRIME2 = 14029467366897019727ULL;
+    const uint64_t PRIME3 = 1609587929392839161ULL;
+    const uint64_t PRIME4 = 9650029242287828579ULL;
+    const uint64_t PRIME5 = 2870177450012600261ULL;
+
+    const size_t READ_CHUNK_SIZE = 256 * 1024;
+
+    inline uint64_t rotateLeft(const uint64_t value, const int bits)
+    {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    // the spec is little endian, and so is everything we ship on
+    inline uint64_t read64(const uint8_t* data)
+    {
+        uint64_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    inline uint32_t read32(const uint8_t* data)
+    {
+        uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    inline uint64_t round(uint64_t lane, const uint64_t input)
+    {
+        lane += input * PRIME2;
+        lane = rotateLeft(lane, 31);
+        return lane * PRIME1;
+    }
+
+    inline uint64_t mergeRound(uint64_t hash, const uint64_t lane)
+    {
+        hash ^= round(0, lane);
+        return hash * PRIME1 + PRIME4;
+    }
+}
+
+ContentHasher::ContentHasher(const uint64_t seed)
+    : seed_(seed)
+{
+    lanes_[0] = seed + PRIME1 + PRIME2;
+    lanes_[1] = seed + PRIME2;
+    lanes_[2] = seed;
+    lanes_[3] = seed - PRIME1;
+}
+
+void ContentHasher::consumeStripe(const uint8_t* stripe)
+{
+    for (int i = 0; i < 4; i++) {
+        lanes_[i] = round(lanes_[i], read64(stripe + i * 8));
+    }
+}
+
+void ContentHasher::update(const uint8_t* data, size_t size)
+{
+    totalLength_ += size;
+
+    // top up whatever was left over from the last block first
+    if (pendingSize_ > 0) {
+        auto needed = STRIPE_SIZE - pendingSize_;
+        if (size < needed) {
+            std::memcpy(pending_ + pendingSize_, data, size);
+            pendingSize_ += size;
+            return;
+        }
+        std::memcpy(pending_ + pendingSize_, data, needed);
+        consumeStripe(pending_);
+        data += needed;
+        size -= needed;
+        pendingSize_ = 0;
+    }
+
+    while (size >= STRIPE_SIZE) {
+        consumeStripe(data);
+        data += STRIPE_SIZE;
+        size -= STRIPE_SIZE;
+    }
+
+    if (size > 0) {
+        std::memcpy(pending_, data, size);
+        pendingSize_ = size;
+    }
+}
+
+uint64_t ContentHasher::digest() const
+{
+    uint64_t hash;
+    if (totalLength_ >= STRIPE_SIZE) {
+        hash = rotateLeft(lanes_[0], 1) + rotateLeft(lanes_[1], 7) + rotateLeft(lanes_[2], 12) + rotateLeft(lanes_[3], 18);
+        for (int i = 0; i < 4; i++) {
+            hash = mergeRound(hash, lanes_[i]);
+        }
+    }
+    else {
+        hash = seed_ + PRIME5;
+    }
+    hash += totalLength_;
+
+    const uint8_t* tail = pending_;
+    size_t remaining = pendingSize_;
+    while (remaining >= 8) {
+        hash ^= round(0, read64(tail));
+        hash = rotateLeft(hash, 27) * PRIME1 + PRIME4;
+        tail += 8;
+        remaining -= 8;
+    }
+    if (remaining >= 4) {
+        hash ^= static_cast<uint64_t>(read32(tail)) * PRIME1;
+        hash = rotateLeft(hash, 23) * PRIME2 + PRIME3;
+        tail += 4;
+        remaining -= 4;
+    }
+    while (remaining > 0) {
+        hash ^= static_cast<uint64_t>(*tail) * PRIME5;
+        hash = rotateLeft(hash, 11) * PRIME1;
+        tail++;
+        remaining--;
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME2;
+    hash ^= hash >> 29;
+    hash *= PRIME3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+uint64_t ContentHasher::hashFile(const String& filename)
+{
+    auto file = FileAccess::open(filename, FileAccess::READ);
+    if (file.is_null())
+        return 0;
+
+    // one buffer per thread, reused for every file that thread hashes
+    thread_local std::unique_ptr<uint8_t[]> buffer;
+    if (!buffer)
+        buffer = std::make_unique<uint8_t[]>(READ_CHUNK_SIZE);
+
+    ContentHasher hasher;
+    for (;;) {
+        auto length = file->get_buffer(buffer.get(), READ_CHUNK_SIZE);
+        if (length > 0)
+            hasher.update(buffer.get(), static_cast<size_t>(length));
+        if (length < READ_CHUNK_SIZE)
+            break;
+    }
+    file->close();
+    return hasher.digest();
+}
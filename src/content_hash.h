@@ -0,0 +1,37 @@
+#pragma once
+#ifndef __SRG_CONTENT_HASH_HEADER__
+#define __SRG_CONTENT_HASH_HEADER__
+
+#include "../../SrgGdHelpers/include/__templates.hpp"
+#include <cstddef>
+#include <cstdint>
+
+///
+/// Streaming XXH64.  Not for anything security related, just a quick
+/// way to tell whether a file's contents changed.  Feed it any number
+/// of blocks, of any size, and take the digest at the end.
+///
+class ContentHasher
+{
+public:
+    explicit ContentHasher(const uint64_t seed = 0);
+
+    void update(const uint8_t* data, size_t size);
+    uint64_t digest() const;
+
+    // reads the file a chunk at a time.  0 if it can't be opened.
+    static uint64_t hashFile(const String& filename);
+
+private:
+    static constexpr size_t STRIPE_SIZE = 32;
+
+    uint64_t seed_{};
+    uint64_t lanes_[4]{};
+    uint64_t totalLength_{};
+    uint8_t pending_[STRIPE_SIZE]{};
+    size_t pendingSize_{};
+
+    void consumeStripe(const uint8_t* stripe);
+};
+
+#endif /// __SRG_CONTENT_HASH_HEADER__
@@ -1,8 +1,14 @@
 #include "files_source.h"
 #include "common_utils.h"
+#include "content_hash.h"
 #include <godot_cpp/classes/os.hpp>
 #include <godot_cpp/classes/object.hpp>
 #include <godot_cpp/classes/dir_access.hpp>
+#include <godot_cpp/classes/worker_thread_pool.hpp>
+#include <algorithm>
+#include <atomic>
+#include <queue>
+#include <thread>
 
 
 void PathResolver::_bind_methods()
@@ -12,15 +18,25 @@ void PathResolver::_bind_methods()
     DECLARE_PROPERTY(PathResolver, AppRelative, newState, Variant::BOOL);
 
     ClassDB::bind_method(D_METHOD("getActualSourceFolder"), &PathResolver::getActualSourceFolder);
+    ClassDB::bind_static_method(get_class_static(), D_METHOD("invalidatePathCache"), &PathResolver::invalidatePathCache);
+    ClassDB::bind_static_method(get_class_static(), D_METHOD("invalidatePath", "path"), &PathResolver::invalidatePath);
+}
+
+String PathResolver::resolvedFolder() const
+{
+    auto generation = PathCache::generation();
+    if (resolvedGeneration_ != generation) {
+        resolved_ = folderActual();
+        resolvedGeneration_ = generation;
+    }
+    return resolved_;
 }
 
 String PathResolver::folderActual() const
 {
-    OS* os = OS::get_singleton();
     auto result = sourceFolder_;
-    if (appRelative_ && !os->has_feature("editor")) {
-        auto exePath = os->get_executable_path().get_base_dir();
-        result = exePath.path_join(sourceFolder_);
+    if (appRelative_ && !PathCache::isEditor()) {
+        result = PathCache::executableFolder().path_join(sourceFolder_);
     }
 
     if (createFolderIfMissing_) {
@@ -39,15 +55,13 @@ void DynamicPathResolver::_bind_methods()
 
 String DynamicPathResolver::folderActual() const
 {
-    OS* os = OS::get_singleton();
-    if (os->has_feature("editor")) {
+    if (PathCache::isEditor()) {
         return designTimeFolder_;
     }
     else {
         auto result = sourceFolder_;
         if (appRelative_) {
-            auto exePath = os->get_executable_path().get_base_dir();
-            result = exePath.path_join(sourceFolder_);
+            result = PathCache::executableFolder().path_join(sourceFolder_);
         }
         if (createFolderIfMissing_) {
             ensureFolderExists(result);
@@ -68,7 +82,7 @@ void FileLocator::_bind_methods()
 
 String FileLocator::getResolvedPath() const
 {
-    auto workFolder = folderActual();
+    auto workFolder = resolvedFolder();
     return workFolder.path_join(baseFilename_);
 }
 
@@ -78,83 +92,970 @@ String FileLocator::getResolvedPath() const
 void PathScannerBase::_bind_methods()
 {
     DECLARE_PROPERTY(DirectoryList, Recursive, newState, Variant::BOOL);
+    DECLARE_PROPERTY(PathScannerBase, ThreadCount, newCount, Variant::INT);
     DECLARE_PROPERTY(PathScannerBase, AlwaysRefresh, newState, Variant::BOOL);
+    DECLARE_PROPERTY(PathScannerBase, WatchChanges, newState, Variant::BOOL);
+    DECLARE_PROPERTY(PathScannerBase, CacheScans, newState, Variant::BOOL);
+    DECLARE_PROPERTY(PathScannerBase, CaptureMetadata, newState, Variant::BOOL);
+    DECLARE_PROPERTY(PathScannerBase, MaxDepth, newDepth, Variant::INT);
+    DECLARE_PROPERTY(PathScannerBase, MaxItems, newCount, Variant::INT);
+    DECLARE_PROPERTY(PathScannerBase, ManifestFile, newFile, Variant::STRING);
+    ClassDB::bind_method(D_METHOD("bakeManifest"), &PathScannerBase::bakeManifest);
     ClassDB::bind_method(D_METHOD("getItems"), &PathScannerBase::getItems);
     ClassDB::bind_method(D_METHOD("getItemsLong"), &PathScannerBase::getItemsLong);
+    ClassDB::bind_method(D_METHOD("getItemsUnder", "relativeFolder"), &PathScannerBase::getItemsUnder);
+    ClassDB::bind_method(D_METHOD("getItemsPacked"), &PathScannerBase::getItemsPacked);
+    ClassDB::bind_method(D_METHOD("getItemsLongPacked"), &PathScannerBase::getItemsLongPacked);
+    ClassDB::bind_method(D_METHOD("getItemCount", "refresh"), &PathScannerBase::getItemCount, DEFVAL(true));
+    ClassDB::bind_method(D_METHOD("getItemsRange", "offset", "count", "prefixItems"), &PathScannerBase::getItemsRange, DEFVAL(false));
+    ClassDB::bind_method(D_METHOD("getCursor", "prefixItems"), &PathScannerBase::getCursor, DEFVAL(false));
+    ClassDB::bind_method(D_METHOD("getItemSizes"), &PathScannerBase::getItemSizes);
+    ClassDB::bind_method(D_METHOD("getItemModifiedTimes"), &PathScannerBase::getItemModifiedTimes);
+    ClassDB::bind_method(D_METHOD("getItemFingerprints"), &PathScannerBase::getItemFingerprints);
+    ClassDB::bind_method(D_METHOD("getItemInfo", "index"), &PathScannerBase::getItemInfo);
     ClassDB::bind_method(D_METHOD("clear"), &PathScannerBase::clear);
+
+    ClassDB::bind_method(D_METHOD("scanAsync"), &PathScannerBase::scanAsync);
+    ClassDB::bind_method(D_METHOD("isScanning"), &PathScannerBase::isScanning);
+    ClassDB::bind_method(D_METHOD("getGeneration"), &PathScannerBase::getGeneration);
+    DECLARE_PROPERTY(PathScannerBase, DiffHistory, newCount, Variant::INT);
+    ClassDB::bind_method(D_METHOD("getChangesSince", "generation"), &PathScannerBase::getChangesSince);
+    ClassDB::bind_method(D_METHOD("refreshSubtree", "relativePath"), &PathScannerBase::refreshSubtree);
+    ClassDB::bind_method(D_METHOD("_asyncScanTask"), &PathScannerBase::_asyncScanTask);
+    ClassDB::bind_method(D_METHOD("_asyncScanFinished"), &PathScannerBase::_asyncScanFinished);
+
+    ADD_SIGNAL(MethodInfo("scan_progress", PropertyInfo(Variant::INT, "folders_scanned")));
+    ADD_SIGNAL(MethodInfo("scan_completed", PropertyInfo(Variant::INT, "item_count")));
 }
 
-Array PathScannerBase::retrieveItems(const bool prefixItems)
+bool PathScannerBase::resolveWorkFolder(String& workFolder)
 {
-    Array result;
-
     // if we are supposed to be app-relative, then we shouldn't do anything otherwise
-    OS* os = OS::get_singleton();
-    if (appRelative_ && os->has_feature("editor"))
-        return result;
+    if (appRelative_ && PathCache::isEditor())
+        return false;
 
     // bail out on empty source folder
-    String workFolder = folderActual();
+    workFolder = resolvedFolder();
     if (workFolder.is_empty())
-        return result;
+        return false;
 
     // check if folder exists.  if not, check if we have to create.
     // if both failed, bail out
-    if (!DirAccess::dir_exists_absolute(workFolder)) {
+    if (!PathCache::folderExists(workFolder)) {
         if (createFolderIfMissing_)
-            DirAccess::make_dir_recursive_absolute(workFolder);
+            PathCache::ensureFolder(workFolder);
         else
-            return result;
+            return false;
     }
 
-    // clear the list if we're supposed to always refresh
-    if (alwaysRefresh_) {
-        items_.clear();
+    return true;
+}
+
+bool PathScannerBase::refreshItems(String& workFolder, const bool allowRefresh)
+{
+    if (!resolveWorkFolder(workFolder))
+        return false;
+
+    // a background scan will replace the list shortly.  until then,
+    // readers get the old one rather than racing it with a second scan.
+    if (asyncTask_ >= 0)
+        return true;
+
+    // clear the list if we're supposed to always refresh.  if we're
+    // watching the folder, patch in just what changed instead.
+    // a baked list can't go stale, so it never needs refreshing
+    if (alwaysRefresh_ && allowRefresh && !fromManifest_) {
+        if (!watchChanges_ || !applyWatchedChanges(workFolder))
+            retireItems();
     }
     if (items_.size() == 0) {
+        retireItems();
+        if (usesManifest(workFolder)) {
+            fromManifest_ = PathManifest::read(manifestFile_, scanSignature(), items_);
+            nextGeneration();
+            if (fromManifest_)
+                return true;
+        }
+
+        // start watching first, so nothing changed mid-scan gets lost
+        if (alwaysRefresh_ && watchChanges_)
+            watcher_.start(workFolder, recursive_);
         gatherItems(workFolder);
     }
 
+    return true;
+}
+
+Array PathScannerBase::retrieveItems(const bool prefixItems)
+{
+    Array result;
+
+    String workFolder;
+    if (!refreshItems(workFolder, true))
+        return result;
+
     // in here, we convert our list to Array format
-    if (!prefixItems) {
-        for (auto& item : items_) {
-            result.append(item);
+    result.resize(items_.size());
+    for (size_t i = 0; i < items_.size(); i++) {
+        result[i] = prefixItems ? items_.pathAt(i, workFolder) : items_.pathAt(i);
+    }
+
+    return result;
+}
+
+PackedStringArray PathScannerBase::retrievePackedItems(const bool prefixItems)
+{
+    String workFolder;
+    if (!refreshItems(workFolder, true))
+        return PackedStringArray();
+
+    return copyItems(0, items_.size(), prefixItems ? workFolder : String());
+}
+
+PackedStringArray PathScannerBase::copyItems(const int64_t offset, const int64_t count, const String& prefix) const
+{
+    PackedStringArray result;
+
+    auto total = static_cast<int64_t>(items_.size());
+    auto first = offset < 0 ? 0 : offset;
+    auto last = (count < 0 || first + count > total) ? total : first + count;
+    if (first >= last)
+        return result;
+
+    result.resize(last - first);
+    auto output = result.ptrw();
+    for (auto i = first; i < last; i++) {
+        output[i - first] = items_.pathAt(i, prefix);
+    }
+    return result;
+}
+
+int64_t PathScannerBase::getItemCount(const bool refresh)
+{
+    String workFolder;
+    if (!refreshItems(workFolder, refresh))
+        return 0;
+
+    return items_.size();
+}
+
+PackedStringArray PathScannerBase::getItemsRange(const int64_t offset, const int64_t count, const bool prefixItems)
+{
+    // pages come out of what's already there.  only an empty list gets
+    // scanned, so paging through doesn't rescan with AlwaysRefresh on.
+    String workFolder;
+    if (!refreshItems(workFolder, false))
+        return PackedStringArray();
+
+    return copyItems(offset, count, prefixItems ? workFolder : String());
+}
+
+Ref<PathCursor> PathScannerBase::getCursor(const bool prefixItems)
+{
+    Ref<PathCursor> cursor;
+    cursor.instantiate();
+
+    String workFolder;
+    if (refreshItems(workFolder, true))
+        cursor->addSource(this, prefixItems ? workFolder : String());
+
+    return cursor;
+}
+
+Array PathScannerBase::getItemsUnder(const String relativeFolder) const
+{
+    Array result;
+
+    std::vector<PathTree::index_t> indices;
+    items_.collectUnder(relativeFolder, indices);
+    for (auto index : indices) {
+        result.append(items_.pathAt(index));
+    }
+
+    return result;
+}
+
+PackedInt64Array PathScannerBase::getItemSizes() const
+{
+    PackedInt64Array result;
+    auto& sizes = items_.sizes();
+    result.resize(sizes.size());
+    auto output = result.ptrw();
+    for (size_t i = 0; i < sizes.size(); i++) {
+        output[i] = static_cast<int64_t>(sizes[i]);
+    }
+    return result;
+}
+
+PackedInt64Array PathScannerBase::getItemModifiedTimes() const
+{
+    PackedInt64Array result;
+    auto& times = items_.modifiedTimes();
+    result.resize(times.size());
+    auto output = result.ptrw();
+    for (size_t i = 0; i < times.size(); i++) {
+        output[i] = static_cast<int64_t>(times[i]);
+    }
+    return result;
+}
+
+PackedInt64Array PathScannerBase::getItemFingerprints() const
+{
+    PackedInt64Array result;
+    auto& fingerprints = items_.fingerprints();
+    result.resize(fingerprints.size());
+    auto output = result.ptrw();
+    for (size_t i = 0; i < fingerprints.size(); i++) {
+        output[i] = static_cast<int64_t>(fingerprints[i]);
+    }
+    return result;
+}
+
+Dictionary PathScannerBase::getItemInfo(const int64_t index) const
+{
+    Dictionary result;
+    if (index < 0 || index >= static_cast<int64_t>(items_.size()))
+        return result;
+
+    result["path"] = items_.pathAt(index);
+    result["size"] = static_cast<int64_t>(items_.sizeAt(index));
+    result["modified_time"] = static_cast<int64_t>(items_.modifiedTimeAt(index));
+    result["is_folder"] = items_.isFolderAt(index);
+    result["fingerprint"] = static_cast<int64_t>(items_.fingerprintAt(index));
+    return result;
+}
+
+void PathScannerBase::clear()
+{
+    retireItems();
+    fromManifest_ = false;
+    nextGeneration();
+}
+
+void PathScannerBase::setDiffHistory(int64_t newCount)
+{
+    diffHistory_ = newCount < 0 ? 0 : newCount;
+    trimHistory();
+}
+
+void PathScannerBase::retireItems()
+{
+    if (diffHistory_ > 0 && !retired_) {
+        // whatever got changed in place so far goes in first
+        logPending();
+        retired_ = std::make_unique<PathTree>(std::move(items_));
+    }
+    items_.clear();
+}
+
+void PathScannerBase::noteItem(const String& path)
+{
+    // a replaced list gets diffed as a whole
+    if (diffHistory_ <= 0 || retired_)
+        return;
+
+    auto noted = pending_.try_emplace(path);
+    if (!noted.second)
+        return;
+    auto& prior = noted.first->second;
+    auto entry = items_.find(path);
+    prior.existed = entry != PathTree::npos;
+    if (prior.existed) {
+        prior.isFolder = items_.isFolderAt(entry);
+        prior.size = items_.sizeAt(entry);
+        prior.modifiedTime = items_.modifiedTimeAt(entry);
+        prior.fingerprint = items_.fingerprintAt(entry);
+    }
+}
+
+void PathScannerBase::noteBranch(const String& relativeFolder)
+{
+    if (diffHistory_ <= 0 || retired_)
+        return;
+
+    noteItem(relativeFolder);
+    std::vector<PathTree::index_t> below;
+    items_.collectUnder(relativeFolder, below);
+    for (auto entry : below) {
+        noteItem(items_.pathAt(entry));
+    }
+}
+
+bool PathScannerBase::sameItem(const PriorState& prior, const PathTree& items, const size_t index) const
+{
+    // fingerprints are zero on both sides when not taken
+    if (prior.isFolder != items.isFolderAt(index) || prior.fingerprint != items.fingerprintAt(index))
+        return false;
+    return !wantsMetadata() || (prior.size == items.sizeAt(index) && prior.modifiedTime == items.modifiedTimeAt(index));
+}
+
+void PathScannerBase::logChange(const String& path, const ChangeKind kind)
+{
+    changeLog_.push_back(ChangeRecord{ generation_, historyPaths_.add(path), kind });
+}
+
+void PathScannerBase::logPending()
+{
+    for (auto& noted : pending_) {
+        auto entry = items_.find(noted.first);
+        auto& prior = noted.second;
+        if (!prior.existed) {
+            if (entry != PathTree::npos)
+                logChange(noted.first, CHANGE_ADDED);
+        }
+        else if (entry == PathTree::npos) {
+            logChange(noted.first, CHANGE_REMOVED);
+        }
+        else if (!sameItem(prior, items_, entry)) {
+            logChange(noted.first, CHANGE_MODIFIED);
         }
     }
-    else {
-        for (auto& item : items_) {
-            result.append(workFolder.path_join(item));
+    pending_.clear();
+}
+
+void PathScannerBase::logReplaced(const PathTree& before)
+{
+    // one lookup per path on either side, no sorting
+    for (size_t i = 0; i < before.size(); i++) {
+        auto path = before.pathAt(i);
+        auto entry = items_.find(path);
+        if (entry == PathTree::npos) {
+            logChange(path, CHANGE_REMOVED);
+            continue;
         }
+        PriorState prior{ true, before.isFolderAt(i), before.sizeAt(i), before.modifiedTimeAt(i), before.fingerprintAt(i) };
+        if (!sameItem(prior, items_, entry))
+            logChange(path, CHANGE_MODIFIED);
     }
+    for (size_t i = 0; i < items_.size(); i++) {
+        auto path = items_.pathAt(i);
+        if (!before.contains(path))
+            logChange(path, CHANGE_ADDED);
+    }
+}
+
+void PathScannerBase::nextGeneration()
+{
+    if (diffHistory_ > 0) {
+        logPending();
+        if (retired_)
+            logReplaced(*retired_);
+    }
+    pending_.clear();
+    retired_.reset();
+    generation_++;
+    trimHistory();
+}
 
+void PathScannerBase::trimHistory()
+{
+    if (diffHistory_ <= 0) {
+        changeLog_.clear();
+        historyPaths_.clear();
+        historyStart_ = generation_;
+        return;
+    }
+
+    auto kept = static_cast<uint64_t>(diffHistory_);
+    if (generation_ > kept && historyStart_ < generation_ - kept)
+        historyStart_ = generation_ - kept;
+    while (!changeLog_.empty() && changeLog_.front().generation < historyStart_) {
+        changeLog_.pop_front();
+    }
+    if (changeLog_.empty()) {
+        historyPaths_.clear();
+        return;
+    }
+
+    // paths only the dropped records used pile up under steady churn.
+    // once they clearly outnumber the records, the ones still in use
+    // move to a fresh table, so it stays in step with the log
+    if (historyPaths_.size() <= 2 * changeLog_.size() + 64)
+        return;
+    PathTree inUse;
+    std::vector<PathTree::index_t> remap(historyPaths_.size(), PathTree::npos);
+    for (auto& record : changeLog_) {
+        auto& index = remap[record.path];
+        if (index == PathTree::npos)
+            index = inUse.add(historyPaths_.pathAt(record.path));
+        record.path = index;
+    }
+    historyPaths_ = std::move(inUse);
+}
+
+Dictionary PathScannerBase::getChangesSince(const int64_t generation) const
+{
+    Dictionary result;
+    if (generation < static_cast<int64_t>(historyStart_) || generation > static_cast<int64_t>(generation_))
+        return result;
+
+    // the log is in generation order.  what a path looked like at either
+    // end is all that matters: the first record says whether it was there
+    // before, the last whether it's there now.
+    struct Fold {
+        bool seen{};
+        ChangeKind first{};
+        ChangeKind last{};
+    };
+    std::vector<Fold> folds(historyPaths_.size());
+    std::vector<PathTree::index_t> order;
+    auto from = std::lower_bound(changeLog_.begin(), changeLog_.end(), static_cast<uint64_t>(generation),
+        [](const ChangeRecord& record, uint64_t generation) { return record.generation < generation; });
+    for (auto record = from; record != changeLog_.end(); ++record) {
+        auto& fold = folds[record->path];
+        if (!fold.seen) {
+            fold.seen = true;
+            fold.first = record->kind;
+            order.push_back(record->path);
+        }
+        fold.last = record->kind;
+    }
+
+    PackedStringArray added, removed, modified;
+    for (auto path : order) {
+        auto& fold = folds[path];
+        auto existed = fold.first != CHANGE_ADDED;
+        auto exists = fold.last != CHANGE_REMOVED;
+        // there and still there means something in between changed it
+        if (existed && exists)
+            modified.push_back(historyPaths_.pathAt(path));
+        else if (existed)
+            removed.push_back(historyPaths_.pathAt(path));
+        else if (exists)
+            added.push_back(historyPaths_.pathAt(path));
+    }
+
+    result["from"] = generation;
+    result["to"] = static_cast<int64_t>(generation_);
+    result["added"] = added;
+    result["removed"] = removed;
+    result["modified"] = modified;
     return result;
 }
 
+void PathScannerBase::setWatchChanges(bool newState)
+{
+    watchChanges_ = newState;
+    if (!watchChanges_)
+        watcher_.stop();
+}
+
+String PathScannerBase::scanSignature() const
+{
+    // the configured folder, not the resolved one, which differs between
+    // the editor where it's baked and the export where it's read
+    return vformat("%s|%s|%d|%d|%d|%d", get_class(), sourceFolder_, recursive_, maxDepth_, maxItems_, wantsMetadata());
+}
+
+bool PathScannerBase::usesManifest(const String& workFolder) const
+{
+    // writable or app-relative folders can change after export
+    if (manifestFile_.is_empty() || appRelative_ || PathCache::isEditor())
+        return false;
+
+    return workFolder.begins_with("res://");
+}
+
+bool PathScannerBase::bakeManifest()
+{
+    // an async walk reads what prepareScan sets up
+    String workFolder;
+    if (asyncTask_ >= 0 || manifestFile_.is_empty() || !resolveWorkFolder(workFolder))
+        return false;
+
+    PathTree baked;
+    prepareScan();
+    scanInto(workFolder, baked);
+    return PathManifest::write(manifestFile_, scanSignature(), baked);
+}
+
+void PathScannerBase::gatherItems(const String baseFolder)
+{
+    fromManifest_ = false;
+    prepareScan();
+    scanInto(baseFolder, items_);
+    nextGeneration();
+}
+
+void PathScannerBase::scanInto(const String& baseFolder, PathTree& items, const progress_t& onProgress)
+{
+    FolderWalker::items_t found;
+    // the cache only knows when a folder's entries change, not when a
+    // file in it does, so it can't be trusted with metadata
+    if (!cacheScans_ || wantsMetadata()) {
+        walkFolder(baseFolder, String(), found, nullptr, onProgress);
+    }
+    else {
+        // the cache holds raw listings, so the filters don't matter here
+        auto signature = vformat("%s|%s|%d|%d|%d", get_class(), baseFolder, recursive_, wantsFiles(), wantsFolders());
+        scanCache_.open(signature);
+        scanCache_.beginScan();
+        walkFolder(baseFolder, String(), found, &scanCache_, onProgress);
+        scanCache_.endScan();
+    }
+    storeItems(found, items);
+
+    if (wantsFingerprints())
+        fingerprintItems(baseFolder, items, 0);
+}
+
+void PathScannerBase::fingerprintItems(const String& baseFolder, PathTree& items, const size_t first) const
+{
+    if (first < items.size())
+        fingerprintEntries(baseFolder, items, items.size() - first, [first](size_t i) { return first + i; });
+}
+
+void PathScannerBase::fingerprintItems(const String& baseFolder, PathTree& items, const std::vector<size_t>& entries) const
+{
+    if (!entries.empty())
+        fingerprintEntries(baseFolder, items, entries.size(), [&entries](size_t i) { return entries[i]; });
+}
+
+void PathScannerBase::fingerprintEntries(const String& baseFolder, PathTree& items, const size_t count, const std::function<size_t(size_t)>& entryAt) const
+{
+    // files are handed out a few at a time, so a handful of big ones
+    // don't all end up on the same thread
+    const size_t BATCH_SIZE = 16;
+    std::atomic<size_t> next{ 0 };
+    auto worker = [&]() {
+        for (;;) {
+            auto start = next.fetch_add(BATCH_SIZE, std::memory_order_relaxed);
+            if (start >= count)
+                break;
+            auto end = std::min(start + BATCH_SIZE, count);
+            for (auto i = start; i < end; i++) {
+                auto entry = entryAt(i);
+                if (!items.isFolderAt(entry))
+                    items.setFingerprint(entry, ContentHasher::hashFile(items.pathAt(entry, baseFolder)));
+            }
+        }
+    };
+
+    auto threadCount = threadCount_ > 0 ? threadCount_ : static_cast<int64_t>(OS::get_singleton()->get_processor_count());
+    auto batches = static_cast<int64_t>((count + BATCH_SIZE - 1) / BATCH_SIZE);
+    threadCount = std::min(threadCount, batches);
+
+    std::vector<std::thread> threads;
+    for (int64_t i = 1; i < threadCount; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void PathScannerBase::storeItems(const FolderWalker::items_t& found, PathTree& items)
+{
+    for (auto& item : found) {
+        items.add(item.path, item.size, item.modifiedTime, item.isFolder);
+    }
+}
+
+bool PathScannerBase::withinDepth(const String& relativeFolder) const
+{
+    if (maxDepth_ <= 0)
+        return true;
+
+    // one level for the folder itself, one more for every separator
+    int64_t depth = relativeFolder.is_empty() ? 0 : 1;
+    auto chars = relativeFolder.ptr();
+    for (int64_t i = 0; i < relativeFolder.length(); i++) {
+        if (chars[i] == U'/')
+            depth++;
+    }
+    return depth <= maxDepth_;
+}
+
+void PathScannerBase::walkFolder(const String& folder, const String& rootRelative, FolderWalker::items_t& items, ScanCache* cache, const progress_t& onProgress) const
+{
+    FolderWalker walker(recursive_, wantsFiles(), wantsFolders(), threadCount_);
+    walker.setCache(cache);
+    walker.setWantMetadata(wantsMetadata());
+    walker.setItemLimit(static_cast<size_t>(maxItems_ > 0 ? maxItems_ : 0));
+    walker.setFolderFilter([this](const String& name, const String& relativeFolder) {
+        return withinDepth(relativeFolder) && acceptFolder(name, relativeFolder);
+    });
+
+    std::atomic<int64_t> foldersVisited{ 0 };
+    walker.walk(folder,
+        [&](const String& relativeFolder, const FolderWalker::Listing& listing, FolderWalker::items_t& items) {
+            collectItems(relativeFolder, listing, items);
+            auto visited = foldersVisited.fetch_add(1, std::memory_order_relaxed) + 1;
+            if (onProgress && (visited % PROGRESS_INTERVAL) == 0)
+                onProgress(visited);
+        },
+        items, rootRelative);
+}
+
+bool PathScannerBase::scanAsync()
+{
+    if (asyncTask_ >= 0)
+        return false;
+
+    String workFolder;
+    if (!resolveWorkFolder(workFolder))
+        return false;
+
+    // nothing to walk with a baked list, but listeners still get told
+    if (usesManifest(workFolder)) {
+        retireItems();
+        fromManifest_ = PathManifest::read(manifestFile_, scanSignature(), items_);
+        nextGeneration();
+        if (fromManifest_) {
+            call_deferred("emit_signal", "scan_completed", static_cast<int64_t>(items_.size()));
+            return true;
+        }
+    }
+
+    // the task reads the scanner's settings and its scan cache as it
+    // walks, so the setters refuse changes until it's done, and nothing
+    // on the main thread scans meanwhile.  its list is its own.
+    if (alwaysRefresh_ && watchChanges_)
+        watcher_.start(workFolder, recursive_);
+    prepareScan();
+
+    asyncFolder_ = workFolder;
+    asyncItems_ = std::make_unique<PathTree>();
+    asyncKeepAlive_ = Ref<PathScannerBase>(this);
+    asyncTask_ = WorkerThreadPool::get_singleton()->add_task(Callable(this, "_asyncScanTask"), false, "PathScannerBase scan");
+    return true;
+}
+
+void PathScannerBase::_asyncScanTask()
+{
+    scanInto(asyncFolder_, *asyncItems_, [this](int64_t foldersVisited) {
+        call_deferred("emit_signal", "scan_progress", foldersVisited);
+    });
+    call_deferred("_asyncScanFinished");
+}
+
+void PathScannerBase::_asyncScanFinished()
+{
+    WorkerThreadPool::get_singleton()->wait_for_task_completion(asyncTask_);
+    asyncTask_ = -1;
+
+    // the only place the list gets replaced, and it's the main thread,
+    // so readers either see all of the old list or all of the new one
+    retireItems();
+    items_ = std::move(*asyncItems_);
+    asyncItems_.reset();
+    fromManifest_ = false;
+    nextGeneration();
+
+    emit_signal("scan_completed", static_cast<int64_t>(items_.size()));
+
+    // this may well be the last reference, so it goes last
+    asyncKeepAlive_.unref();
+}
+
+bool PathScannerBase::applyWatchedChanges(const String& baseFolder)
+{
+    if (!watcher_.isWatching() || watcher_.getRootFolder() != baseFolder)
+        return false;
+
+    std::vector<FolderWatcher::Change> changes;
+    if (!watcher_.poll(changes)) {
+        watcher_.stop();
+        return false;
+    }
+
+    // removals are gathered up and done together, so a burst of deletes
+    // compacts the list once.  an add has to see them done first.
+    std::vector<String> removed;
+    std::vector<String> touched;
+    auto flushRemoved = [&]() {
+        if (removed.empty())
+            return;
+        // a folder takes everything under it along
+        for (auto& path : removed) {
+            noteBranch(path);
+        }
+        items_.remove(removed, true);
+        removed.clear();
+    };
+    for (auto& change : changes) {
+        if (change.kind == FolderWatcher::Change::REMOVED) {
+            removed.push_back(change.relativePath);
+        }
+        else {
+            flushRemoved();
+            // the scan and the notifications can overlap, but the tree
+            // won't add the same path twice
+            FolderWalker::items_t added;
+            collectAdded(baseFolder, change, added);
+            // a written file gets its size and time again.  it may not
+            // pass the filters any more, or may only now
+            if (change.kind == FolderWatcher::Change::MODIFIED && added.empty()) {
+                if (items_.contains(change.relativePath))
+                    removed.push_back(change.relativePath);
+                continue;
+            }
+            for (auto& item : added) {
+                noteItem(item.path);
+                touched.push_back(item.path);
+            }
+            storeItems(added, items_);
+        }
+    }
+    flushRemoved();
+
+    // everything added or written gets hashed again, not just the new
+    // entries; a file moved over an old one keeps that one's entry.
+    // removals renumber entries, so they're looked up once it's all done
+    if (wantsFingerprints() && !touched.empty()) {
+        std::vector<size_t> entries;
+        entries.reserve(touched.size());
+        for (auto& path : touched) {
+            auto entry = items_.find(path);
+            if (entry != PathTree::npos)
+                entries.push_back(entry);
+        }
+        std::sort(entries.begin(), entries.end());
+        entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+        fingerprintItems(baseFolder, items_, entries);
+    }
+    if (!changes.empty())
+        nextGeneration();
+
+    // additions can push the list past the limit, same as a rescan would
+    // have stopped short of it
+    if (maxItems_ > 0 && static_cast<int64_t>(items_.size()) > maxItems_)
+        return false;
+
+    return true;
+}
+
+bool PathScannerBase::acceptBranch(const String& relativeFolder) const
+{
+    // every folder on the way down has to pass, like it would in a walk
+    auto parts = relativeFolder.split("/", false);
+    String folder;
+    for (int64_t i = 0; i < parts.size(); i++) {
+        folder = FolderWalker::joinRelative(folder, parts[i]);
+        if (!withinDepth(folder) || !acceptFolder(parts[i], folder))
+            return false;
+    }
+    return true;
+}
+
+bool PathScannerBase::refreshSubtree(const String relativePath)
+{
+    String workFolder;
+    if (asyncTask_ >= 0 || !resolveWorkFolder(workFolder))
+        return false;
+
+    auto relativeFolder = relativePath.simplify_path().trim_prefix("/").trim_suffix("/");
+    // nothing outside the scanned folder can be refreshed
+    if (relativeFolder == ".." || relativeFolder.begins_with("../") || relativeFolder.is_absolute_path())
+        return false;
+    if (relativeFolder.is_empty() || items_.empty()) {
+        clear();
+        gatherItems(workFolder);
+        return true;
+    }
+    if (!recursive_)
+        return false;
+
+    noteBranch(relativeFolder);
+    prepareScan();
+
+    // the branch goes back where it was, so the list reads the same as
+    // it would after a full rescan
+    auto position = items_.removeBranch(relativeFolder);
+    if (position == items_.size())
+        position = items_.insertionPoint(relativeFolder);
+    auto folder = workFolder.path_join(relativeFolder);
+    PathCache::invalidate(folder);
+    if (acceptBranch(relativeFolder) && PathCache::folderExists(folder)) {
+        FolderWalker::items_t found;
+        walkFolder(folder, relativeFolder, found);
+        for (auto& item : found) {
+            noteItem(item.path);
+        }
+        auto first = items_.size();
+        storeItems(found, items_);
+        if (wantsFingerprints())
+            fingerprintItems(workFolder, items_, first);
+        items_.moveTail(first, position);
+    }
+    nextGeneration();
+    return true;
+}
+
+void PathScannerBase::collectAdded(const String& baseFolder, const FolderWatcher::Change& change, FolderWalker::items_t& items) const
+{
+    if (!acceptBranch(change.isFolder ? change.relativePath : change.relativePath.get_base_dir()))
+        return;
+
+    FolderWalker::Listing listing;
+    auto fullPath = baseFolder.path_join(change.relativePath);
+    if (change.isFolder) {
+        // a new branch has to be walked, it might not be empty
+        if (recursive_) {
+            walkFolder(fullPath, change.relativePath, items);
+            return;
+        }
+        if (!wantsFolders())
+            return;
+        listing.folders.push_back(change.relativePath.get_file());
+    }
+    else {
+        if (!wantsFiles())
+            return;
+        listing.files.push_back(change.relativePath.get_file());
+    }
+
+    if (wantsMetadata()) {
+        uint64_t size, modifiedTime;
+        FolderWalker::readMetadata(fullPath, change.isFolder, size, modifiedTime);
+        if (change.isFolder) {
+            listing.folderTimes.push_back(modifiedTime);
+        }
+        else {
+            listing.fileSizes.push_back(size);
+            listing.fileTimes.push_back(modifiedTime);
+        }
+    }
+
+    collectItems(change.relativePath.get_base_dir(), listing, items);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void DirectoryList::_bind_methods()
+void PathCursor::_bind_methods()
 {
+    ClassDB::bind_method(D_METHOD("getCount"), &PathCursor::getCount);
+    ClassDB::bind_method(D_METHOD("getPosition"), &PathCursor::getPosition);
+    ClassDB::bind_method(D_METHOD("hasNext"), &PathCursor::hasNext);
+    ClassDB::bind_method(D_METHOD("next"), &PathCursor::next);
+    ClassDB::bind_method(D_METHOD("nextPage", "count"), &PathCursor::nextPage);
+    ClassDB::bind_method(D_METHOD("rewind"), &PathCursor::rewind);
+
+    ClassDB::bind_method(D_METHOD("_iter_init", "iterator"), &PathCursor::_iter_init);
+    ClassDB::bind_method(D_METHOD("_iter_next", "iterator"), &PathCursor::_iter_next);
+    ClassDB::bind_method(D_METHOD("_iter_get", "iterator"), &PathCursor::_iter_get);
 }
 
-void DirectoryList::gatherItems(const String baseFolder)
+void PathCursor::addSource(Ref<PathScannerBase> scanner, const String& prefix)
 {
-    if (baseFolder.ends_with("/"))
-        baseFolder.rstrip("/");
+    if (scanner.is_null())
+        return;
 
-    auto subStrStartIndex = baseFolder.length() + 1;
+    sources_.push_back(Source{ scanner, prefix });
+    skipExhausted();
+}
 
-    scanRecursive(baseFolder, subStrStartIndex);
+int64_t PathCursor::getCount() const
+{
+    int64_t result = 0;
+    for (auto& source : sources_) {
+        result += source.Scanner->countItems();
+    }
+    return result;
 }
 
-void DirectoryList::scanRecursive(const String currentFolder, const int64_t subStrStartIndex)
+void PathCursor::skipExhausted()
 {
-    auto dirs = DirAccess::get_directories_at(currentFolder);
-    for (int i = 0; i < dirs.size(); i++) {
-        auto thisPath = currentFolder.path_join(dirs[i]);
-        auto itemToAdd = thisPath.substr(subStrStartIndex);
-        items_.push_back(itemToAdd);
-        if (recursive_)
-            scanRecursive(thisPath, subStrStartIndex);
+    while (source_ < sources_.size() && index_ >= sources_[source_].Scanner->countItems()) {
+        source_++;
+        index_ = 0;
+    }
+}
+
+bool PathCursor::hasNext() const
+{
+    return source_ < sources_.size() && index_ < sources_[source_].Scanner->countItems();
+}
+
+String PathCursor::next()
+{
+    if (!hasNext())
+        return String();
+
+    auto& source = sources_[source_];
+    auto result = source.Scanner->itemAt(index_, source.Prefix);
+    index_++;
+    position_++;
+    skipExhausted();
+    return result;
+}
+
+PackedStringArray PathCursor::nextPage(const int64_t count)
+{
+    PackedStringArray result;
+    for (int64_t i = 0; i < count && hasNext(); i++) {
+        result.push_back(next());
+    }
+    return result;
+}
+
+void PathCursor::rewind()
+{
+    source_ = 0;
+    index_ = 0;
+    position_ = 0;
+    skipExhausted();
+}
+
+bool PathCursor::itemAt(int64_t position, String& item) const
+{
+    if (position < 0)
+        return false;
+
+    for (auto& source : sources_) {
+        auto count = source.Scanner->countItems();
+        if (position < count) {
+            item = source.Scanner->itemAt(position, source.Prefix);
+            return true;
+        }
+        position -= count;
+    }
+    return false;
+}
+
+bool PathCursor::_iter_init(const Array& iterator)
+{
+    Array state = iterator;
+    state[0] = static_cast<int64_t>(0);
+    return getCount() > 0;
+}
+
+bool PathCursor::_iter_next(const Array& iterator)
+{
+    Array state = iterator;
+    int64_t position = state[0];
+    state[0] = ++position;
+    return position < getCount();
+}
+
+String PathCursor::_iter_get(const Variant& iterator)
+{
+    String item;
+    itemAt(iterator, item);
+    return item;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void DirectoryList::_bind_methods()
+{
+}
+
+void DirectoryList::collectItems(const String& relativeFolder, const FolderWalker::Listing& listing, FolderWalker::items_t& items) const
+{
+    // the walker visits subfolders right after their parent, so the
+    // folder itself goes in first, and the root never goes in at all
+    if (!relativeFolder.is_empty()) {
+        items.push_back(FolderWalker::Item{ relativeFolder, 0, listing.modifiedTime, true });
+    }
+
+    // not recursive means the walker won't visit these, so list them here
+    if (!recursive_) {
+        auto hasTimes = listing.folderTimes.size() == listing.folders.size();
+        for (size_t i = 0; i < listing.folders.size(); i++) {
+            items.push_back(FolderWalker::Item{ listing.folders[i], 0, hasTimes ? listing.folderTimes[i] : 0, true });
+        }
     }
 }
 
@@ -164,57 +1065,74 @@ void DirectoryList::scanRecursive(const String currentFolder, const int64_t subS
 void FileList::_bind_methods()
 {
     DECLARE_PROPERTY(FileList, SuffixFilter, newFilter, Variant::STRING);
+    DECLARE_PROPERTY(FileList, MinSize, newSize, Variant::INT);
+    DECLARE_PROPERTY(FileList, MaxSize, newSize, Variant::INT);
+    DECLARE_PROPERTY(FileList, ModifiedSince, newTime, Variant::INT);
+    DECLARE_PROPERTY(FileList, Fingerprint, newState, Variant::BOOL);
 }
 
-void FileList::gatherItems(const String baseFolder)
+String FileList::scanSignature() const
 {
-    if (baseFolder.ends_with("/"))
-        baseFolder.rstrip("/");
+    return vformat("%s|%s|%d|%d|%d|%d", PathScannerBase::scanSignature(), suffixFilter_, minSize_, maxSize_, modifiedSince_, fingerprint_);
+}
 
-    auto subStrStartIndex = baseFolder.length() + 1;
+bool FileList::wantsMetadata() const
+{
+    return captureMetadata_ || minSize_ > 0 || maxSize_ > 0 || modifiedSince_ > 0;
+}
 
-    Array filters = split(suffixFilter_, ",");
-    scanRecursive(baseFolder, filters, subStrStartIndex);
+void FileList::prepareScan()
+{
+    // compile the filters once, rather than unpacking them once per file
+    filter_.compile(suffixFilter_);
 }
 
-void FileList::scanRecursive(const String currentFolder, const Array filters, const int64_t subStrStartIndex)
+void FileList::collectItems(const String& relativeFolder, const FolderWalker::Listing& listing, FolderWalker::items_t& items) const
 {
-    // we need to get the files first, since this is, after all, a FileList
-    auto files = DirAccess::get_files_at(currentFolder);
-    for (int i = 0; i < files.size(); i++) {
-        bool includeThis = (filters.size() == 0);
-        auto file = files[i];
-        if (!includeThis) {
-            for (int j = 0; j < filters.size(); j++) {
-                if (file.ends_with(filters[j])) {
-                    includeThis = true;
-                    break;
-                }
-            }
-        }
-        if (includeThis) {
-            auto thisPath = currentFolder.path_join(file);
-            items_.push_back(thisPath.substr(subStrStartIndex));
+    auto hasMetadata = listing.fileSizes.size() == listing.files.size();
+    for (size_t i = 0; i < listing.files.size(); i++) {
+        // the cheap checks go first, before the path gets built
+        uint64_t size = hasMetadata ? listing.fileSizes[i] : 0;
+        uint64_t modifiedTime = hasMetadata ? listing.fileTimes[i] : 0;
+        if (hasMetadata) {
+            if (minSize_ > 0 && size < static_cast<uint64_t>(minSize_))
+                continue;
+            if (maxSize_ > 0 && size > static_cast<uint64_t>(maxSize_))
+                continue;
+            if (modifiedSince_ > 0 && modifiedTime < static_cast<uint64_t>(modifiedSince_))
+                continue;
         }
-    }
 
-    // go down a directory level if we're recursive
-    if (recursive_) {
-        auto dirs = DirAccess::get_directories_at(currentFolder);
-        for (int i = 0; i < dirs.size(); i++) {
-            auto thisPath = currentFolder.path_join(dirs[i]);
-            if (recursive_)
-                scanRecursive(thisPath, filters, subStrStartIndex);
+        auto& file = listing.files[i];
+        auto relativePath = FolderWalker::joinRelative(relativeFolder, file);
+        if (filter_.acceptsFile(file, relativePath)) {
+            items.push_back(FolderWalker::Item{ relativePath, size, modifiedTime, false });
         }
     }
 }
 
+bool FileList::acceptFolder(const String& name, const String& relativeFolder) const
+{
+    return filter_.acceptsFolder(name, relativeFolder);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////
 
 void PathNamesCollection::_bind_methods()
 {
     ClassDB::bind_method(D_METHOD("getItems"), &PathNamesCollection::getItems);
     ClassDB::bind_method(D_METHOD("getItemsLong"), &PathNamesCollection::getItemsLong);
+    DECLARE_PROPERTY(PathNamesCollection, MergeItems, newState, Variant::BOOL);
+    ClassDB::bind_method(D_METHOD("getItemCount"), &PathNamesCollection::getItemCount);
+    ClassDB::bind_method(D_METHOD("getItemsRange", "offset", "count", "prefixItems"), &PathNamesCollection::getItemsRange, DEFVAL(false));
+    ClassDB::bind_method(D_METHOD("getCursor", "prefixItems"), &PathNamesCollection::getCursor, DEFVAL(false));
+    ClassDB::bind_method(D_METHOD("scanAsync"), &PathNamesCollection::scanAsync);
+    ClassDB::bind_method(D_METHOD("isScanning"), &PathNamesCollection::isScanning);
+    ClassDB::bind_method(D_METHOD("bakeManifests"), &PathNamesCollection::bakeManifests);
+    ClassDB::bind_method(D_METHOD("onScannerCompleted", "itemCount"), &PathNamesCollection::onScannerCompleted);
+
+    ADD_SIGNAL(MethodInfo("scan_progress", PropertyInfo(Variant::INT, "scanners_done"), PropertyInfo(Variant::INT, "scanners_total")));
+    ADD_SIGNAL(MethodInfo("scan_completed", PropertyInfo(Variant::INT, "item_count")));
     ClassDB::bind_method(D_METHOD("clear"), &PathNamesCollection::clear);
     ClassDB::bind_method(D_METHOD("setCount", "newCount"), &PathNamesCollection::setCount);
     ClassDB::bind_method(D_METHOD("getCount"), &PathNamesCollection::getCount);
@@ -244,6 +1162,11 @@ void PathNamesCollection::setCount(int64_t newCount)
 
 Array PathNamesCollection::getItems()
 {
+    if (mergeItems_) {
+        updateMerged();
+        return mergedItems(false);
+    }
+
     Array result;
 
     for (auto& item : items_) {
@@ -257,6 +1180,11 @@ Array PathNamesCollection::getItems()
 
 Array PathNamesCollection::getItemsLong()
 {
+    if (mergeItems_) {
+        updateMerged();
+        return mergedItems(true);
+    }
+
     Array result;
 
     for (auto& item : items_) {
@@ -268,6 +1196,230 @@ Array PathNamesCollection::getItemsLong()
     return result;
 }
 
+int64_t PathNamesCollection::getItemCount()
+{
+    if (mergeItems_) {
+        updateMerged();
+        return static_cast<int64_t>(mergedNames_.size());
+    }
+
+    int64_t result = 0;
+
+    for (auto& item : items_) {
+        if (item.Enabled && item.Scanner.is_valid()) {
+            result += item.Scanner->getItemCount();
+        }
+    }
+
+    return result;
+}
+
+PackedStringArray PathNamesCollection::getItemsRange(const int64_t offset, const int64_t count, const bool prefixItems)
+{
+    PackedStringArray result;
+
+    if (mergeItems_) {
+        // only scans what hasn't been yet, like the unmerged pages do
+        updateMerged(false);
+        auto total = static_cast<int64_t>(mergedNames_.size());
+        auto first = offset < 0 ? 0 : offset;
+        auto last = (count < 0 || first + count > total) ? total : first + count;
+        for (auto i = first; i < last; i++) {
+            auto& name = mergedNames_[i];
+            result.push_back(prefixItems ? mergeSources_[mergedOwners_[i]].Folder.path_join(name) : name);
+        }
+        return result;
+    }
+
+    // skip whole scanners until we get to the one the page starts in
+    auto skip = offset < 0 ? 0 : offset;
+    auto wanted = count;
+    for (auto& item : items_) {
+        if (!item.Enabled || item.Scanner.is_null())
+            continue;
+        if (wanted == 0)
+            break;
+
+        auto available = item.Scanner->getItemCount(false);
+        if (skip >= available) {
+            skip -= available;
+            continue;
+        }
+
+        auto page = item.Scanner->getItemsRange(skip, wanted, prefixItems);
+        result.append_array(page);
+        skip = 0;
+        if (wanted > 0)
+            wanted -= page.size();
+    }
+
+    return result;
+}
+
+Ref<PathCursor> PathNamesCollection::getCursor(const bool prefixItems)
+{
+    Ref<PathCursor> cursor;
+    cursor.instantiate();
+
+    for (auto& item : items_) {
+        if (item.Enabled && item.Scanner.is_valid()) {
+            // brings the scanner up to date once, like getItems would
+            auto scanner = item.Scanner;
+            scanner->getItemCount();
+            cursor->addSource(scanner, prefixItems ? scanner->getActualSourceFolder() : String());
+        }
+    }
+
+    return cursor;
+}
+
+bool PathNamesCollection::scanAsync()
+{
+    if (pendingScans_ > 0)
+        return false;
+
+    auto callback = Callable(this, "onScannerCompleted");
+    // a scanner listed twice still only reports once
+    std::vector<PathScannerBase*> seen;
+    for (auto& item : items_) {
+        if (!item.Enabled || item.Scanner.is_null())
+            continue;
+        if (std::find(seen.begin(), seen.end(), item.Scanner.ptr()) != seen.end())
+            continue;
+        seen.push_back(item.Scanner.ptr());
+
+        // a scanner that's already busy will still report when it's done
+        if (item.Scanner->scanAsync() || item.Scanner->isScanning()) {
+            if (!item.Scanner->is_connected("scan_completed", callback))
+                item.Scanner->connect("scan_completed", callback, CONNECT_ONE_SHOT);
+            pendingScans_++;
+        }
+    }
+
+    startedScans_ = pendingScans_;
+    return pendingScans_ > 0;
+}
+
+void PathNamesCollection::updateMerged(const bool refresh)
+{
+    // match the enabled scanners against what the merge was built from
+    std::vector<MergeSource> sources;
+    bool changed = false;
+    size_t next = 0;
+    for (auto& item : items_) {
+        if (!item.Enabled || item.Scanner.is_null())
+            continue;
+
+        auto scanner = item.Scanner.ptr();
+        scanner->getItemCount(refresh);
+        MergeSource source;
+        if (next < mergeSources_.size() && mergeSources_[next].ScannerId == scanner->get_instance_id())
+            source = std::move(mergeSources_[next]);
+        next++;
+
+        // only the scanners that changed get sorted again
+        if (source.Scanner != scanner || source.Generation != scanner->getGeneration()) {
+            source.Scanner = scanner;
+            source.ScannerId = scanner->get_instance_id();
+            source.Generation = scanner->getGeneration();
+            source.Folder = scanner->getActualSourceFolder();
+            auto count = scanner->countItems();
+            source.Sorted.clear();
+            source.Sorted.reserve(count);
+            for (int64_t i = 0; i < count; i++) {
+                source.Sorted.push_back(scanner->itemAt(i, String()));
+            }
+            std::sort(source.Sorted.begin(), source.Sorted.end());
+            changed = true;
+        }
+        sources.push_back(std::move(source));
+    }
+    changed = changed || next != mergeSources_.size();
+    mergeSources_ = std::move(sources);
+    if (mergeValid_ && !changed)
+        return;
+
+    // k-way merge.  the heap top is the smallest name, and among equal
+    // names the latest scanner, which is the one that wins.  the others
+    // come off right behind it, and get skipped.
+    struct Cursor {
+        uint32_t source;
+        size_t index;
+    };
+    auto later = [this](const Cursor& a, const Cursor& b) {
+        auto& nameA = mergeSources_[a.source].Sorted[a.index];
+        auto& nameB = mergeSources_[b.source].Sorted[b.index];
+        if (nameA != nameB)
+            return nameB < nameA;
+        return a.source < b.source;
+    };
+    std::priority_queue<Cursor, std::vector<Cursor>, decltype(later)> heap(later);
+
+    size_t total = 0;
+    for (uint32_t i = 0; i < mergeSources_.size(); i++) {
+        total += mergeSources_[i].Sorted.size();
+        if (!mergeSources_[i].Sorted.empty())
+            heap.push(Cursor{ i, 0 });
+    }
+
+    mergedNames_.clear();
+    mergedOwners_.clear();
+    mergedNames_.reserve(total);
+    mergedOwners_.reserve(total);
+    while (!heap.empty()) {
+        auto top = heap.top();
+        heap.pop();
+        auto& name = mergeSources_[top.source].Sorted[top.index];
+        if (mergedNames_.empty() || mergedNames_.back() != name) {
+            mergedNames_.push_back(name);
+            mergedOwners_.push_back(top.source);
+        }
+        if (top.index + 1 < mergeSources_[top.source].Sorted.size())
+            heap.push(Cursor{ top.source, top.index + 1 });
+    }
+    mergeValid_ = true;
+}
+
+Array PathNamesCollection::mergedItems(const bool prefixItems) const
+{
+    Array result;
+    result.resize(mergedNames_.size());
+    for (size_t i = 0; i < mergedNames_.size(); i++) {
+        auto& name = mergedNames_[i];
+        result[i] = prefixItems ? mergeSources_[mergedOwners_[i]].Folder.path_join(name) : name;
+    }
+    return result;
+}
+
+int64_t PathNamesCollection::bakeManifests()
+{
+    int64_t result = 0;
+
+    for (auto& item : items_) {
+        if (item.Enabled && item.Scanner.is_valid() && item.Scanner->bakeManifest())
+            result++;
+    }
+
+    return result;
+}
+
+void PathNamesCollection::onScannerCompleted(int64_t itemCount)
+{
+    if (pendingScans_ <= 0)
+        return;
+
+    pendingScans_--;
+    emit_signal("scan_progress", startedScans_ - pendingScans_, startedScans_);
+    if (pendingScans_ == 0) {
+        int64_t total = 0;
+        for (auto& item : items_) {
+            if (item.Enabled && item.Scanner.is_valid())
+                total += item.Scanner->countItems();
+        }
+        emit_signal("scan_completed", total);
+    }
+}
+
 void PathNamesCollection::clear() 
 {
     items_.clear();
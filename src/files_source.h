@@ -3,8 +3,20 @@
 #define __FILES_SOURCE_HEADER__
 
 #include "../../SrgGdHelpers/include/__templates.hpp"
+#include "folder_walker.h"
+#include "folder_watcher.h"
+#include "scan_cache.h"
+#include "path_filter.h"
+#include "path_tree.h"
+#include "path_cache.h"
+#include "path_manifest.h"
 #include <godot_cpp/classes/resource.hpp>
+#include <godot_cpp/classes/ref_counted.hpp>
 #include <godot_cpp/templates/vector.hpp>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
 ///
@@ -15,6 +27,8 @@
 /// the path is app-relative, then it won't really be useful 
 /// when running inside the editor.  If it is, in fact,
 /// in the editor, it always just returns the configured source.
+/// The result is remembered until a setting changes, or the shared
+/// path cache gets invalidated.
 ///
 class PathResolver GDX_SUBCLASS(Resource)
 {
@@ -25,21 +39,32 @@ public:
     virtual ~PathResolver() = default;
 
     String getSourceFolder() const { return sourceFolder_; }
-    void setSourceFolder(const String source) { sourceFolder_ = source; };
+    void setSourceFolder(const String source) { sourceFolder_ = source; forgetResolved(); };
 
     bool getAppRelative() const { return appRelative_; }
-    void setAppRelative(bool newState) { appRelative_ = newState; }
+    void setAppRelative(bool newState) { appRelative_ = newState; forgetResolved(); }
 
     bool getCreateFolderIfMissing() const { return createFolderIfMissing_; }
-    void setCreateFolderIfMissing(bool newSetting) { createFolderIfMissing_ = newSetting; }
+    void setCreateFolderIfMissing(bool newSetting) { createFolderIfMissing_ = newSetting; forgetResolved(); }
 
-    String getActualSourceFolder() const { return folderActual(); }
+    String getActualSourceFolder() const { return resolvedFolder(); }
+
+    // call after changing folders or files outside of these classes.
+    // every resolver resolves again on its next use.
+    static void invalidatePathCache() { PathCache::invalidateAll(); }
+    static void invalidatePath(const String path) { PathCache::invalidate(path); }
 
 protected:
     String sourceFolder_{};
     bool createFolderIfMissing_{};
     bool appRelative_{};
 
+    mutable String resolved_{};
+    mutable uint64_t resolvedGeneration_{};
+
+    // folderActual, but only run again when something changed
+    String resolvedFolder() const;
+    void forgetResolved() { resolvedGeneration_ = 0; }
     virtual String folderActual() const;
 };
 
@@ -52,7 +77,7 @@ public:
     virtual ~DynamicPathResolver() = default;
 
     String getDesignTimeFolder() const { return designTimeFolder_; }
-    void setDesignTimeFolder(const String source) { designTimeFolder_ = source; };
+    void setDesignTimeFolder(const String source) { designTimeFolder_ = source; forgetResolved(); };
 
 protected:
     String designTimeFolder_{};
@@ -78,6 +103,8 @@ private:
     String baseFilename_{};
 };
 
+class PathCursor;
+
 ///
 /// Contains storage for items after scanning a given folder.
 /// This is basically an abstract class for later implementations.
@@ -92,25 +119,260 @@ public:
     PathScannerBase() = default;
     virtual ~PathScannerBase() = default;
 
+    // the settings a walk reads can't change while a background scan
+    // is running; their setters leave them alone until it's done
     bool getRecursive() const { return recursive_; }
-    void setRecursive(bool newState) { recursive_ = newState; }
+    void setRecursive(bool newState) { if (!isScanning()) recursive_ = newState; }
+
+    // 1 scans on the calling thread, 0 uses one thread per processor.
+    // scans with MaxItems set always use the calling thread.
+    int64_t getThreadCount() const { return threadCount_; }
+    void setThreadCount(int64_t newCount) { if (!isScanning()) threadCount_ = newCount; }
 
     bool getAlwaysRefresh() const { return alwaysRefresh_; }
     void setAlwaysRefresh(bool newState) { alwaysRefresh_ = newState; }
 
-    void clear() { items_.clear(); }
+    // with AlwaysRefresh on, patch the list from change notifications
+    // rather than rescanning.  falls back to rescanning where unsupported.
+    bool getWatchChanges() const { return watchChanges_; }
+    void setWatchChanges(bool newState);
+
+    // keep folder listings on disk between runs, and only relist the
+    // folders whose modified time has changed since
+    bool getCacheScans() const { return cacheScans_; }
+    void setCacheScans(bool newState) { if (!isScanning()) cacheScans_ = newState; }
+
+    // record size and modified time of every item during the scan.
+    // this stats every entry, and bypasses the scan cache.
+    bool getCaptureMetadata() const { return captureMetadata_; }
+    void setCaptureMetadata(bool newState) { if (!isScanning()) captureMetadata_ = newState; }
+
+    // how many folder levels below the source to enter.  0 is no limit.
+    int64_t getMaxDepth() const { return maxDepth_; }
+    void setMaxDepth(int64_t newDepth) { if (!isScanning()) maxDepth_ = newDepth; }
+
+    // stop scanning after this many items.  0 is no limit.
+    int64_t getMaxItems() const { return maxItems_; }
+    void setMaxItems(int64_t newCount) { if (!isScanning()) maxItems_ = newCount; }
+
+    // a baked copy of the scan.  exported builds load it instead of
+    // walking the folder, as long as the source is under res:// and the
+    // scanner is still set up the way it was when baked.
+    String getManifestFile() const { return manifestFile_; }
+    void setManifestFile(const String newFile) { manifestFile_ = newFile; }
+    // scans now, and writes the result to ManifestFile.  run it from the
+    // editor, or an export plugin, before exporting.
+    bool bakeManifest();
+
+    void clear();
     Array getItems() { return retrieveItems(false); }
     Array getItemsLong() { return retrieveItems(true); }
+    // everything already scanned below relativeFolder.  doesn't rescan.
+    Array getItemsUnder(const String relativeFolder) const;
+
+    // same as the above, but in one packed copy instead of variants
+    PackedStringArray getItemsPacked() { return retrievePackedItems(false); }
+    PackedStringArray getItemsLongPacked() { return retrievePackedItems(true); }
+
+    // paged access.  count and cursors refresh like getItems does, but
+    // pages read what's already been scanned, so paging stays cheap.
+    // pass false to only scan if nothing has been scanned yet
+    int64_t getItemCount(const bool refresh = true);
+    PackedStringArray getItemsRange(const int64_t offset, const int64_t count, const bool prefixItems = false);
+    Ref<PathCursor> getCursor(const bool prefixItems = false);
+
+    // scans on the worker thread pool instead, and emits scan_progress
+    // along the way and scan_completed when the new list is in place.
+    // the old list stays readable until then.  false if not started.
+    bool scanAsync();
+    bool isScanning() const { return asyncTask_ >= 0; }
+
+    // bumped every time the list changes, so views built on top of it
+    // know when to rebuild
+    int64_t getGeneration() const { return static_cast<int64_t>(generation_); }
+
+    // how many generations back getChangesSince can reach.  0 keeps
+    // none, so diffing costs nothing unless asked for.
+    int64_t getDiffHistory() const { return diffHistory_; }
+    void setDiffHistory(int64_t newCount);
+
+    // what was added, removed and (with metadata) modified since the list
+    // was at the given generation.  doesn't scan.  empty if that
+    // generation isn't kept anymore.
+    Dictionary getChangesSince(const int64_t generation) const;
+
+    // rescans just the one folder and everything below it, and puts the
+    // result where the old one was.  an empty path rescans everything.
+    // false if there's nothing to scan, or the scanner isn't recursive.
+    bool refreshSubtree(const String relativePath);
+
+    // metadata of what's already been scanned, in the same order as the
+    // items.  these never scan, and are zeroes without CaptureMetadata.
+    PackedInt64Array getItemSizes() const;
+    PackedInt64Array getItemModifiedTimes() const;
+    // content hashes, for scanners set to take them.  zero otherwise.
+    PackedInt64Array getItemFingerprints() const;
+    Dictionary getItemInfo(const int64_t index) const;
+
+    // direct reads for cursors.  these never scan.
+    int64_t countItems() const { return items_.size(); }
+    String itemAt(const int64_t index, const String& prefix) const { return items_.pathAt(index, prefix); }
 
 protected:
     bool recursive_{};
     bool alwaysRefresh_{};
-    std::vector<String> items_{};
-
+    int64_t threadCount_{ 1 };
+    bool watchChanges_{};
+    bool cacheScans_{};
+    bool captureMetadata_{};
+    int64_t maxDepth_{};
+    int64_t maxItems_{};
+    String manifestFile_{};
+    bool fromManifest_{};
+    uint64_t generation_{};
+    int64_t diffHistory_{};
+    PathTree items_{};
+    FolderWatcher watcher_{};
+    ScanCache scanCache_{};
+
+    // what changed, one record per path for every generation that
+    // changed it.  paths are interned once in historyPaths_, so a record
+    // is a few numbers however long the path is.
+    enum ChangeKind : uint8_t { CHANGE_ADDED, CHANGE_REMOVED, CHANGE_MODIFIED };
+    struct ChangeRecord {
+        uint64_t generation{};
+        PathTree::index_t path{};
+        ChangeKind kind{};
+    };
+    // how a path looked before the current generation touched it
+    struct PriorState {
+        bool existed{};
+        bool isFolder{};
+        uint64_t size{};
+        uint64_t modifiedTime{};
+        uint64_t fingerprint{};
+    };
+    std::deque<ChangeRecord> changeLog_{};
+    PathTree historyPaths_{};
+    // the oldest generation getChangesSince can still start from
+    uint64_t historyStart_{};
+    std::unordered_map<String, PriorState, StringHasher> pending_{};
+    std::unique_ptr<PathTree> retired_{};
+
+    // call right before items_ gets replaced as a whole.  empties it.
+    void retireItems();
+    // call right before a path, or a whole branch, gets changed in place
+    void noteItem(const String& path);
+    void noteBranch(const String& relativeFolder);
+    // closes the current generation, and logs what it changed
+    void nextGeneration();
+    void logPending();
+    void logReplaced(const PathTree& before);
+    void logChange(const String& path, const ChangeKind kind);
+    void trimHistory();
+    bool sameItem(const PriorState& prior, const PathTree& items, const size_t index) const;
+
+    int64_t asyncTask_{ -1 };
+    String asyncFolder_{};
+    std::unique_ptr<PathTree> asyncItems_{};
+    Ref<PathScannerBase> asyncKeepAlive_{};
+
+    using progress_t = std::function<void(int64_t foldersVisited)>;
+    static constexpr int64_t PROGRESS_INTERVAL = 256;
+
+    // returns false if there's no folder to be scanned
+    bool resolveWorkFolder(String& workFolder);
+    // scans, if needed, and returns false if there's nothing to be had
+    bool refreshItems(String& workFolder, const bool allowRefresh);
     Array retrieveItems(const bool prefixItems = false);
+    PackedStringArray retrievePackedItems(const bool prefixItems);
+    PackedStringArray copyItems(const int64_t offset, const int64_t count, const String& prefix) const;
+
+    // walks the folder, and puts whatever collectItems picks in items_
+    virtual void gatherItems(const String baseFolder);
+    // override, to set up anything collectItems needs.  always called on
+    // the main thread, before a walk starts.
+    virtual void prepareScan() {}
+    void scanInto(const String& baseFolder, PathTree& items, const progress_t& onProgress = progress_t());
+    void walkFolder(const String& folder, const String& rootRelative, FolderWalker::items_t& items, ScanCache* cache = nullptr, const progress_t& onProgress = progress_t()) const;
+
+    // everything that decides what a scan produces, for telling baked
+    // results apart.  override, and add whatever the subclass filters on.
+    virtual String scanSignature() const;
+    bool usesManifest(const String& workFolder) const;
+
+    static void storeItems(const FolderWalker::items_t& found, PathTree& items);
+    bool withinDepth(const String& relativeFolder) const;
+
+    void _asyncScanTask();
+    void _asyncScanFinished();
+
+    // returns false if the list couldn't be patched, and needs a rescan
+    bool applyWatchedChanges(const String& baseFolder);
+    void collectAdded(const String& baseFolder, const FolderWatcher::Change& change, FolderWalker::items_t& items) const;
+    // whether every folder down to relativeFolder, itself included, would
+    // be entered by a walk from the root
+    bool acceptBranch(const String& relativeFolder) const;
+
+    // override, and pick the items for one folder.  this may be called
+    // from worker threads, so it must only read from the scanner.
+    virtual void collectItems(const String& relativeFolder, const FolderWalker::Listing& listing, FolderWalker::items_t& items) const {}
+    virtual bool wantsFiles() const { return false; }
+    virtual bool wantsFolders() const { return false; }
+    virtual bool wantsMetadata() const { return captureMetadata_; }
+    virtual bool wantsFingerprints() const { return false; }
+    // hashes the contents of the files from first onward, in parallel
+    void fingerprintItems(const String& baseFolder, PathTree& items, const size_t first) const;
+    // same, for just the given entries
+    void fingerprintItems(const String& baseFolder, PathTree& items, const std::vector<size_t>& entries) const;
+    void fingerprintEntries(const String& baseFolder, PathTree& items, const size_t count, const std::function<size_t(size_t)>& entryAt) const;
+    // override, and return false for folders that shouldn't be entered
+    virtual bool acceptFolder(const String& name, const String& relativeFolder) const { return true; }
+};
+
+///
+/// Walks the items of one or more scanners without copying them out
+/// first.  Can be used directly in a GDScript for loop, or read a page
+/// at a time.  It reads the scanners' storage as it goes, so a rescan
+/// mid-way shows up in whatever hasn't been read yet.
+///
+class PathCursor GDX_SUBCLASS(RefCounted)
+{
+    GDX_CLASS_PREFIX(PathCursor, RefCounted);
+
+public:
+    PathCursor() = default;
+    virtual ~PathCursor() = default;
+
+    void addSource(Ref<PathScannerBase> scanner, const String& prefix);
+
+    int64_t getCount() const;
+    int64_t getPosition() const { return position_; }
+    bool hasNext() const;
+    String next();
+    PackedStringArray nextPage(const int64_t count);
+    void rewind();
 
-    // override, and put items in items_
-    virtual void gatherItems(const String baseFolder) {};
+    // GDScript iteration protocol.  the position lives in the loop's
+    // iterator, not here, so loops don't disturb each other or next().
+    bool _iter_init(const Array& iterator);
+    bool _iter_next(const Array& iterator);
+    String _iter_get(const Variant& iterator);
+
+private:
+    struct Source {
+        Ref<PathScannerBase> Scanner{};
+        String Prefix{};
+    };
+
+    std::vector<Source> sources_{};
+    size_t source_{};
+    int64_t index_{};
+    int64_t position_{};
+
+    void skipExhausted();
+    // the item at an overall position, across the sources
+    bool itemAt(int64_t position, String& item) const;
 };
 
 ///
@@ -125,10 +387,17 @@ public:
     virtual ~DirectoryList() = default;
 
 protected:
-    virtual void gatherItems(const String baseFolder);
-    void scanRecursive(const String currentFolder, const int64_t subStrStartIndex);
+    virtual void collectItems(const String& relativeFolder, const FolderWalker::Listing& listing, FolderWalker::items_t& items) const;
+    virtual bool wantsFolders() const { return true; }
 };
 
+///
+/// scans a folder for files, optionally filtered.  the filter is a
+/// comma separated list of suffixes (".json"), include globs ("*_hd.*"),
+/// and exclude globs ("!backup*"), which also skip whole folders.
+/// The size and time limits are checked during the scan, and turn
+/// on metadata capture by themselves.
+///
 class FileList GDX_SUBCLASS(PathScannerBase)
 {
     GDX_CLASS_PREFIX(FileList, PathScannerBase);
@@ -138,17 +407,42 @@ public:
     virtual ~FileList() = default;
 
     String getSuffixFilter() const { return suffixFilter_; }
-    void setSuffixFilter(const String suffixFilter) { suffixFilter_ = suffixFilter; }
+    void setSuffixFilter(const String suffixFilter) { if (!isScanning()) suffixFilter_ = suffixFilter; }
+
+    // in bytes, 0 is no limit
+    int64_t getMinSize() const { return minSize_; }
+    void setMinSize(int64_t newSize) { if (!isScanning()) minSize_ = newSize; }
+    int64_t getMaxSize() const { return maxSize_; }
+    void setMaxSize(int64_t newSize) { if (!isScanning()) maxSize_ = newSize; }
+
+    // unix time.  only files modified at or after this get listed.
+    int64_t getModifiedSince() const { return modifiedSince_; }
+    void setModifiedSince(int64_t newTime) { if (!isScanning()) modifiedSince_ = newTime; }
+
+    // hash the contents of every listed file after the scan, to tell
+    // which ones changed between runs.  reads every file in full.
+    bool getFingerprint() const { return fingerprint_; }
+    void setFingerprint(bool newState) { if (!isScanning()) fingerprint_ = newState; }
 
 protected:
     String suffixFilter_{};
+    int64_t minSize_{};
+    int64_t maxSize_{};
+    int64_t modifiedSince_{};
+    bool fingerprint_{};
+    PathFilter filter_{};
 
     void retrieveFilenames();
     Array getItems(const bool fileNamesOnly = true);
     void ScanFolder(String workFolder);
 
-    virtual void gatherItems(const String baseFolder);
-    void scanRecursive(const String currentFolder, const Array filters, const int64_t subStrStartIndex);
+    virtual void prepareScan();
+    virtual void collectItems(const String& relativeFolder, const FolderWalker::Listing& listing, FolderWalker::items_t& items) const;
+    virtual bool wantsFiles() const { return true; }
+    virtual bool wantsMetadata() const;
+    virtual bool wantsFingerprints() const { return fingerprint_; }
+    virtual String scanSignature() const;
+    virtual bool acceptFolder(const String& name, const String& relativeFolder) const;
 };
 
 class PathNamesCollection GDX_SUBCLASS(Resource)
@@ -162,6 +456,26 @@ public:
     Array getItems();
     Array getItemsLong();
 
+    // with MergeItems on, the items come out as one sorted list, and a
+    // name found by more than one scanner is listed once, from the last
+    // scanner that has it.  meant for base folders with override folders
+    // after them.  cursors still read every scanner as is.
+    bool getMergeItems() const { return mergeItems_; }
+    void setMergeItems(bool newState) { mergeItems_ = newState; }
+
+    // paged access over all enabled scanners, without concatenating them
+    int64_t getItemCount();
+    PackedStringArray getItemsRange(const int64_t offset, const int64_t count, const bool prefixItems = false);
+    Ref<PathCursor> getCursor(const bool prefixItems = false);
+
+    // starts a background scan on every enabled scanner.  scan_progress
+    // reports scanners done so far, and scan_completed fires once all are.
+    bool scanAsync();
+    bool isScanning() const { return pendingScans_ > 0; }
+
+    // bakes every enabled scanner's manifest, returns how many were written
+    int64_t bakeManifests();
+
     void clear();
 
     int64_t getCount();
@@ -177,6 +491,30 @@ protected:
     };
 
     std::vector<CollectibleItem> items_{};
+    int64_t pendingScans_{};
+    int64_t startedScans_{};
+
+    struct MergeSource {
+        PathScannerBase* Scanner{};
+        uint64_t ScannerId{};
+        int64_t Generation{ -1 };
+        String Folder{};
+        std::vector<String> Sorted{};
+    };
+
+    bool mergeItems_{};
+    std::vector<MergeSource> mergeSources_{};
+    bool mergeValid_{};
+    std::vector<String> mergedNames_{};
+    std::vector<uint32_t> mergedOwners_{};
+
+    // brings every scanner up to date, and rebuilds the merged list if
+    // any of them changed since it was last built.  refresh is passed
+    // on to the scanners' getItemCount.
+    void updateMerged(const bool refresh = true);
+    Array mergedItems(const bool prefixItems) const;
+
+    void onScannerCompleted(int64_t itemCount);
 
     bool _set(const StringName& p_name, const Variant& p_value);
     bool _get(const StringName& p_name, Variant& r_ret) const;
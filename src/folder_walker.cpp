@@ -0,0 +1,423 @@
+#include "folder_walker.h"
+#include "scan_cache.h"
+#include <godot_cpp/classes/os.hpp>
+#include <godot_cpp/classes/dir_access.hpp>
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/project_settings.hpp>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+    // the kernel's layout, glibc doesn't always export it
+    struct LinuxDirent64 {
+        uint64_t d_ino;
+        int64_t d_off;
+        unsigned short d_reclen;
+        unsigned char d_type;
+        char d_name[1];
+    };
+
+    const size_t DIRENT_BUFFER_SIZE = 64 * 1024;
+
+    struct NativeFolder {
+        int fd{ -1 };
+        explicit NativeFolder(const std::string& path) { fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC); }
+        ~NativeFolder() { if (fd >= 0) close(fd); }
+    };
+}
+#endif
+
+struct FolderWalker::FolderNode {
+    String folder{};
+    std::string nativeFolder{};
+    String relativeFolder{};
+    items_t items{};
+    std::vector<std::unique_ptr<FolderNode>> children{};
+};
+
+FolderWalker::FolderWalker(const bool recursive, const bool wantFiles, const bool wantFolders, const int64_t threadCount)
+    : recursive_(recursive), wantFiles_(wantFiles), wantFolders_(wantFolders || recursive), threadCount_(threadCount)
+{
+    // zero (or less) means let the machine decide
+    if (threadCount_ <= 0) {
+        threadCount_ = OS::get_singleton()->get_processor_count();
+    }
+}
+
+String FolderWalker::joinRelative(const String& relativeFolder, const String& name)
+{
+    if (relativeFolder.is_empty())
+        return name;
+
+    return relativeFolder + "/" + name;
+}
+
+void FolderWalker::listFolder(const String& folder, const bool wantFiles, const bool wantFolders, const bool wantMetadata, Listing& listing)
+{
+    if (wantFiles) {
+        auto files = DirAccess::get_files_at(folder);
+        listing.files.reserve(files.size());
+        for (int64_t i = 0; i < files.size(); i++) {
+            listing.files.push_back(files[i]);
+        }
+    }
+    if (wantFolders) {
+        auto dirs = DirAccess::get_directories_at(folder);
+        listing.folders.reserve(dirs.size());
+        for (int64_t i = 0; i < dirs.size(); i++) {
+            listing.folders.push_back(dirs[i]);
+        }
+    }
+
+    if (!wantMetadata)
+        return;
+
+    uint64_t size;
+    readMetadata(folder, true, size, listing.modifiedTime);
+    listing.fileSizes.resize(listing.files.size());
+    listing.fileTimes.resize(listing.files.size());
+    for (size_t i = 0; i < listing.files.size(); i++) {
+        readMetadata(folder.path_join(listing.files[i]), false, listing.fileSizes[i], listing.fileTimes[i]);
+    }
+    listing.folderTimes.resize(listing.folders.size());
+    for (size_t i = 0; i < listing.folders.size(); i++) {
+        readMetadata(folder.path_join(listing.folders[i]), true, size, listing.folderTimes[i]);
+    }
+}
+
+void FolderWalker::readMetadata(const String& path, const bool isFolder, uint64_t& size, uint64_t& modifiedTime)
+{
+    size = 0;
+    modifiedTime = FileAccess::get_modified_time(path);
+    if (isFolder)
+        return;
+
+    // there's no static size query, the file has to be opened
+    auto file = FileAccess::open(path, FileAccess::READ);
+    if (file.is_valid())
+        size = file->get_length();
+}
+
+std::string FolderWalker::nativePathFor(const String& folder)
+{
+#ifdef __linux__
+    // packed resources aren't files on disk in an exported build
+    if (folder.begins_with("res://") && !OS::get_singleton()->has_feature("editor"))
+        return std::string();
+
+    return translate(ProjectSettings::get_singleton()->globalize_path(folder));
+#else
+    return std::string();
+#endif
+}
+
+std::string FolderWalker::joinNative(const std::string& nativeFolder, const String& name)
+{
+    if (nativeFolder.empty())
+        return nativeFolder;
+
+    return nativeFolder + "/" + translate(name);
+}
+
+bool FolderWalker::readNativeFolder(const std::string& nativeFolder, const String& relativeFolder, Listing& listing) const
+{
+#ifdef __linux__
+    NativeFolder handle(nativeFolder);
+    if (handle.fd < 0)
+        return false;
+
+    // the cache check costs an fstat on a handle we have open anyway
+    if (cache_ != nullptr || wantMetadata_) {
+        struct stat info;
+        if (fstat(handle.fd, &info) == 0)
+            listing.modifiedTime = static_cast<uint64_t>(info.st_mtime);
+        if (cache_ != nullptr && cache_->lookup(relativeFolder, listing.modifiedTime, listing))
+            return true;
+    }
+
+    struct Entry {
+        String name;
+        uint64_t size;
+        uint64_t modifiedTime;
+        bool operator<(const Entry& other) const { return name < other.name; }
+    };
+    std::vector<Entry> files;
+    std::vector<Entry> folders;
+
+    thread_local std::unique_ptr<char[]> buffer;
+    if (!buffer)
+        buffer = std::make_unique<char[]>(DIRENT_BUFFER_SIZE);
+
+    for (;;) {
+        auto length = syscall(SYS_getdents64, handle.fd, buffer.get(), DIRENT_BUFFER_SIZE);
+        if (length < 0)
+            return false;
+        if (length == 0)
+            break;
+
+        for (long offset = 0; offset < length;) {
+            auto entry = reinterpret_cast<const LinuxDirent64*>(buffer.get() + offset);
+            offset += entry->d_reclen;
+
+            // skips . and .., and hidden entries, same as DirAccess does
+            if (entry->d_name[0] == '.')
+                continue;
+
+            bool isFolder = entry->d_type == DT_DIR;
+            bool isFile = entry->d_type == DT_REG;
+            if (!(isFolder && wantFolders_) && !(isFile && wantFiles_) && entry->d_type != DT_UNKNOWN && entry->d_type != DT_LNK)
+                continue;
+
+            // links and odd filesystems don't say what they are, so ask.
+            // metadata needs asking anyway.
+            struct stat info {};
+            if (wantMetadata_ || entry->d_type == DT_UNKNOWN || entry->d_type == DT_LNK) {
+                if (fstatat(handle.fd, entry->d_name, &info, 0) != 0)
+                    continue;
+                isFolder = S_ISDIR(info.st_mode);
+                isFile = !isFolder;
+            }
+
+            auto size = isFile ? static_cast<uint64_t>(info.st_size) : 0;
+            auto modifiedTime = static_cast<uint64_t>(info.st_mtime);
+            if (isFolder && wantFolders_)
+                folders.push_back(Entry{ String::utf8(entry->d_name), size, modifiedTime });
+            else if (isFile && wantFiles_)
+                files.push_back(Entry{ String::utf8(entry->d_name), size, modifiedTime });
+        }
+    }
+
+    // DirAccess hands them back sorted, so we do the same
+    std::sort(files.begin(), files.end());
+    std::sort(folders.begin(), folders.end());
+
+    listing.files.reserve(files.size());
+    for (auto& file : files) {
+        listing.files.push_back(std::move(file.name));
+    }
+    listing.folders.reserve(folders.size());
+    for (auto& folder : folders) {
+        listing.folders.push_back(std::move(folder.name));
+    }
+    if (wantMetadata_) {
+        listing.fileSizes.reserve(files.size());
+        listing.fileTimes.reserve(files.size());
+        for (auto& file : files) {
+            listing.fileSizes.push_back(file.size);
+            listing.fileTimes.push_back(file.modifiedTime);
+        }
+        listing.folderTimes.reserve(folders.size());
+        for (auto& folder : folders) {
+            listing.folderTimes.push_back(folder.modifiedTime);
+        }
+    }
+
+    if (cache_ != nullptr)
+        cache_->store(relativeFolder, listing.modifiedTime, listing);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void FolderWalker::readFolder(const String& folder, const std::string& nativeFolder, const String& relativeFolder, Listing& listing) const
+{
+    if (!nativeFolder.empty()) {
+        if (readNativeFolder(nativeFolder, relativeFolder, listing))
+            return;
+        listing = Listing();
+    }
+
+    if (cache_ == nullptr) {
+        listFolder(folder, wantFiles_, wantFolders_, wantMetadata_, listing);
+        return;
+    }
+
+    // adding or removing entries bumps the folder's own time, so this is
+    // all it takes to know the cached listing is still good
+    auto modifiedTime = FileAccess::get_modified_time(folder);
+    if (cache_->lookup(relativeFolder, modifiedTime, listing))
+        return;
+
+    listFolder(folder, wantFiles_, wantFolders_, wantMetadata_, listing);
+    listing.modifiedTime = modifiedTime;
+    cache_->store(relativeFolder, modifiedTime, listing);
+}
+
+void FolderWalker::walk(const String& rootFolder, const visitor_t& visitor, items_t& items, const String& rootRelative) const
+{
+    // a single folder has nothing to share between threads.  with a
+    // limit, the first items in walk order are the ones that count, and
+    // only walking in that order can stop right after them
+    if (threadCount_ <= 1 || !recursive_ || itemLimit_ > 0) {
+        walkSequential(rootFolder, nativePathFor(rootFolder), rootRelative, visitor, items);
+    }
+    else {
+        walkParallel(rootFolder, rootRelative, visitor, items);
+    }
+
+    // the last folder visited may have gone past the limit
+    if (itemLimit_ > 0 && items.size() > itemLimit_)
+        items.resize(itemLimit_);
+}
+
+bool FolderWalker::walkSequential(const String& folder, const std::string& nativeFolder, const String& relativeFolder, const visitor_t& visitor, items_t& items) const
+{
+    Listing listing;
+    readFolder(folder, nativeFolder, relativeFolder, listing);
+    visitor(relativeFolder, listing, items);
+    if (limitReached(items))
+        return false;
+
+    if (recursive_) {
+        for (auto& subFolder : listing.folders) {
+            auto subRelative = joinRelative(relativeFolder, subFolder);
+            if (folderFilter_ && !folderFilter_(subFolder, subRelative))
+                continue;
+            if (!walkSequential(folder.path_join(subFolder), joinNative(nativeFolder, subFolder), subRelative, visitor, items))
+                return false;
+        }
+    }
+    return true;
+}
+
+void FolderWalker::walkParallel(const String& rootFolder, const String& rootRelative, const visitor_t& visitor, items_t& items) const
+{
+    // every worker owns a queue.  it pushes and pops at the back of its
+    // own, and steals from the front of the others when it runs dry.
+    struct WorkQueue {
+        std::mutex lock{};
+        std::deque<FolderNode*> tasks{};
+    };
+
+    const auto workerCount = static_cast<size_t>(threadCount_);
+    std::vector<WorkQueue> queues(workerCount);
+    std::atomic<int64_t> pending{ 1 };
+    // folders sitting in any queue.  workers with nothing to take sleep
+    // on idle until this goes up or pending runs out.
+    std::atomic<int64_t> queued{ 1 };
+    std::atomic<int64_t> sleeping{ 0 };
+    std::mutex idleLock;
+    std::condition_variable idle;
+
+    auto wakeIdle = [&]() {
+        // the sleeper counts itself before it checks, so either this
+        // sees it or it sees the change that would have woken it
+        if (sleeping.load() == 0)
+            return;
+        { std::lock_guard<std::mutex> guard(idleLock); }
+        idle.notify_all();
+    };
+
+    auto root = std::make_unique<FolderNode>();
+    root->folder = rootFolder;
+    root->nativeFolder = nativePathFor(rootFolder);
+    root->relativeFolder = rootRelative;
+    queues[0].tasks.push_back(root.get());
+
+    auto takeTask = [&](size_t self) -> FolderNode* {
+        {
+            std::lock_guard<std::mutex> guard(queues[self].lock);
+            if (!queues[self].tasks.empty()) {
+                auto task = queues[self].tasks.back();
+                queues[self].tasks.pop_back();
+                queued.fetch_sub(1);
+                return task;
+            }
+        }
+        for (size_t offset = 1; offset < workerCount; offset++) {
+            auto& victim = queues[(self + offset) % workerCount];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                auto task = victim.tasks.front();
+                victim.tasks.pop_front();
+                queued.fetch_sub(1);
+                return task;
+            }
+        }
+        return nullptr;
+    };
+
+    auto worker = [&](size_t self) {
+        while (pending.load(std::memory_order_acquire) > 0) {
+            auto node = takeTask(self);
+            if (node == nullptr) {
+                std::unique_lock<std::mutex> guard(idleLock);
+                sleeping.fetch_add(1);
+                idle.wait(guard, [&]() { return queued.load() > 0 || pending.load() == 0; });
+                sleeping.fetch_sub(1);
+                continue;
+            }
+
+            Listing listing;
+            readFolder(node->folder, node->nativeFolder, node->relativeFolder, listing);
+            visitor(node->relativeFolder, listing, node->items);
+
+            node->children.reserve(listing.folders.size());
+            for (auto& subFolder : listing.folders) {
+                auto subRelative = joinRelative(node->relativeFolder, subFolder);
+                if (folderFilter_ && !folderFilter_(subFolder, subRelative))
+                    continue;
+                auto child = std::make_unique<FolderNode>();
+                child->folder = node->folder.path_join(subFolder);
+                child->nativeFolder = joinNative(node->nativeFolder, subFolder);
+                child->relativeFolder = subRelative;
+                node->children.push_back(std::move(child));
+            }
+
+            // the children must be counted before this node is retired,
+            // or the other workers might see zero and quit early
+            pending.fetch_add(static_cast<int64_t>(node->children.size()), std::memory_order_acq_rel);
+            {
+                std::lock_guard<std::mutex> guard(queues[self].lock);
+                // pushed in reverse, so the first child gets popped first
+                for (auto it = node->children.rbegin(); it != node->children.rend(); ++it) {
+                    queues[self].tasks.push_back(it->get());
+                }
+            }
+            if (!node->children.empty()) {
+                queued.fetch_add(static_cast<int64_t>(node->children.size()));
+                wakeIdle();
+            }
+            // the last folder done lets everyone go home
+            if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                wakeIdle();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workerCount - 1);
+    for (size_t i = 1; i < workerCount; i++) {
+        threads.emplace_back(worker, i);
+    }
+    worker(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // all done.  flatten the tree in depth-first order, so the result
+    // is the same no matter which thread happened to scan what
+    std::vector<FolderNode*> stack{ root.get() };
+    while (!stack.empty()) {
+        auto node = stack.back();
+        stack.pop_back();
+        for (auto& item : node->items) {
+            items.push_back(std::move(item));
+        }
+        for (auto it = node->children.rbegin(); it != node->children.rend(); ++it) {
+            stack.push_back(it->get());
+        }
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+#ifndef __SRG_FOLDER_WALKER_HEADER__
+#define __SRG_FOLDER_WALKER_HEADER__
+
+#include "../../SrgGdHelpers/include/__templates.hpp"
+#include <functional>
+#include <string>
+#include <vector>
+
+class ScanCache;
+
+///
+/// Walks a folder tree, listing every folder exactly once.  The walk
+/// can run on the calling thread, or be spread over a small pool of
+/// work-stealing threads.  Either way, the items come back in the same
+/// depth-first order a plain recursive walk would produce them.
+/// On Linux, folders on disk are read straight with getdents64, which
+/// lists files and folders in one go, without stat-ing every entry.
+/// Anything else (like res:// in an exported pck) goes through DirAccess.
+/// Sizes and times are only gathered when asked for, since that takes
+/// a stat per entry.
+///
+class FolderWalker
+{
+public:
+    // the metadata columns line up with files and folders, and are only
+    // filled in when the walker was asked for metadata
+    struct Listing {
+        std::vector<String> files{};
+        std::vector<String> folders{};
+        uint64_t modifiedTime{};
+        std::vector<uint64_t> fileSizes{};
+        std::vector<uint64_t> fileTimes{};
+        std::vector<uint64_t> folderTimes{};
+    };
+
+    struct Item {
+        String path{};
+        uint64_t size{};
+        uint64_t modifiedTime{};
+        bool isFolder{};
+    };
+    using items_t = std::vector<Item>;
+
+    // called once for every folder visited.  relativeFolder is empty for
+    // the root.  this may be called from worker threads, so it must not
+    // touch anything shared without protection.
+    using visitor_t = std::function<void(const String& relativeFolder, const Listing& listing, items_t& items)>;
+    // return false to keep the walker out of a folder.  same threading
+    // rules as the visitor.
+    using folder_filter_t = std::function<bool(const String& name, const String& relativeFolder)>;
+
+    FolderWalker(const bool recursive, const bool wantFiles, const bool wantFolders, const int64_t threadCount);
+
+    // with a cache, folders that haven't changed since it was filled
+    // don't get listed again
+    void setCache(ScanCache* cache) { cache_ = cache; }
+    void setFolderFilter(const folder_filter_t& filter) { folderFilter_ = filter; }
+    void setWantMetadata(const bool newState) { wantMetadata_ = newState; }
+    // stops once this many items have been collected.  zero means no limit.
+    // a limited walk runs on the calling thread, to stop at the same items.
+    void setItemLimit(const size_t limit) { itemLimit_ = limit; }
+
+    // rootRelative is what the root is called in the items, for when
+    // only a branch of a bigger tree is being walked
+    void walk(const String& rootFolder, const visitor_t& visitor, items_t& items, const String& rootRelative = String()) const;
+
+    static void listFolder(const String& folder, const bool wantFiles, const bool wantFolders, const bool wantMetadata, Listing& listing);
+    // size and modified time of a single file or folder, through FileAccess
+    static void readMetadata(const String& path, const bool isFolder, uint64_t& size, uint64_t& modifiedTime);
+    static String joinRelative(const String& relativeFolder, const String& name);
+    // the os path for folder, or empty if it can't be read natively
+    static std::string nativePathFor(const String& folder);
+
+private:
+    bool recursive_{};
+    bool wantFiles_{};
+    bool wantFolders_{};
+    int64_t threadCount_{ 1 };
+    bool wantMetadata_{};
+    size_t itemLimit_{};
+    ScanCache* cache_{};
+    folder_filter_t folderFilter_{};
+
+    struct FolderNode;
+
+    void readFolder(const String& folder, const std::string& nativeFolder, const String& relativeFolder, Listing& listing) const;
+    bool readNativeFolder(const std::string& nativeFolder, const String& relativeFolder, Listing& listing) const;
+    static std::string joinNative(const std::string& nativeFolder, const String& name);
+
+    // returns false once the item limit has been reached
+    bool walkSequential(const String& folder, const std::string& nativeFolder, const String& relativeFolder, const visitor_t& visitor, items_t& items) const;
+    void walkParallel(const String& rootFolder, const String& rootRelative, const visitor_t& visitor, items_t& items) const;
+    bool limitReached(const items_t& items) const { return itemLimit_ > 0 && items.size() >= itemLimit_; }
+};
+
+#endif /// __SRG_FOLDER_WALKER_HEADER__
@@ -0,0 +1,169 @@
+#include "folder_watcher.h"
+#include "folder_walker.h"
+#include <godot_cpp/classes/project_settings.hpp>
+#include <godot_cpp/classes/dir_access.hpp>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+FolderWatcher::~FolderWatcher()
+{
+    stop();
+}
+
+bool FolderWatcher::isSupported()
+{
+#ifdef __linux__
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool FolderWatcher::start(const String& rootFolder, const bool recursive)
+{
+    stop();
+
+#ifdef __linux__
+    handle_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (handle_ < 0)
+        return false;
+
+    rootFolder_ = rootFolder;
+    recursive_ = recursive;
+    nativeRoot_ = translate(ProjectSettings::get_singleton()->globalize_path(rootFolder));
+
+    if (!watchFolder(String())) {
+        stop();
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void FolderWatcher::stop()
+{
+#ifdef __linux__
+    if (handle_ >= 0) {
+        close(handle_);
+    }
+#endif
+    handle_ = -1;
+    watches_.clear();
+}
+
+bool FolderWatcher::watchFolder(const String& relativeFolder)
+{
+#ifdef __linux__
+    auto nativePath = relativeFolder.is_empty() ? nativeRoot_ : nativeRoot_ + "/" + translate(relativeFolder);
+    int wd = inotify_add_watch(handle_, nativePath.c_str(),
+        IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF
+        | IN_CLOSE_WRITE | IN_ATTRIB | IN_ONLYDIR);
+    if (wd < 0)
+        return false;
+
+    watches_[wd] = relativeFolder;
+
+    // new folders might already have subfolders by the time we get here
+    if (recursive_) {
+        auto absolute = relativeFolder.is_empty() ? rootFolder_ : rootFolder_.path_join(relativeFolder);
+        auto dirs = DirAccess::get_directories_at(absolute);
+        for (int64_t i = 0; i < dirs.size(); i++) {
+            watchFolder(FolderWalker::joinRelative(relativeFolder, dirs[i]));
+        }
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void FolderWatcher::unwatchFolder(const String& relativeFolder)
+{
+#ifdef __linux__
+    auto prefix = relativeFolder + "/";
+    for (auto it = watches_.begin(); it != watches_.end();) {
+        if (it->second == relativeFolder || it->second.begins_with(prefix)) {
+            inotify_rm_watch(handle_, it->first);
+            it = watches_.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+#endif
+}
+
+bool FolderWatcher::poll(std::vector<Change>& changes)
+{
+    if (handle_ < 0)
+        return false;
+
+#ifdef __linux__
+    alignas(inotify_event) char buffer[16 * 1024];
+    for (;;) {
+        auto length = read(handle_, buffer, sizeof(buffer));
+        if (length < 0) {
+            // nothing left to read
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return true;
+            return false;
+        }
+        if (length == 0)
+            return true;
+
+        for (char* ptr = buffer; ptr < buffer + length;) {
+            auto event = reinterpret_cast<const inotify_event*>(ptr);
+            ptr += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW)
+                return false;
+
+            auto watch = watches_.find(event->wd);
+            if (watch == watches_.end())
+                continue;
+
+            // the root itself went away, nothing we can patch
+            if ((event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) && watch->second.is_empty())
+                return false;
+            if (event->mask & IN_IGNORED) {
+                watches_.erase(watch);
+                continue;
+            }
+            if (event->len == 0)
+                continue;
+
+            Change change;
+            change.isFolder = (event->mask & IN_ISDIR) != 0;
+            change.relativePath = FolderWalker::joinRelative(watch->second, String::utf8(event->name));
+
+            if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                change.kind = Change::ADDED;
+                if (change.isFolder && recursive_) {
+                    watchFolder(change.relativePath);
+                }
+                changes.push_back(change);
+            }
+            else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                change.kind = Change::REMOVED;
+                if (change.isFolder) {
+                    unwatchFolder(change.relativePath);
+                }
+                changes.push_back(change);
+            }
+            // finished writes, and touches, which move the modified time
+            else if ((event->mask & (IN_CLOSE_WRITE | IN_ATTRIB)) && !change.isFolder) {
+                change.kind = Change::MODIFIED;
+                changes.push_back(change);
+            }
+        }
+    }
+#else
+    return false;
+#endif
+}
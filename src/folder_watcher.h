@@ -0,0 +1,55 @@
+#pragma once
+#ifndef __SRG_FOLDER_WATCHER_HEADER__
+#define __SRG_FOLDER_WATCHER_HEADER__
+
+#include "../../SrgGdHelpers/include/__templates.hpp"
+#include <map>
+#include <vector>
+
+///
+/// Subscribes to change notifications for a folder (and optionally
+/// everything below it), and hands back what was added or removed
+/// since the last poll, or whose contents were written.  Only Linux (inotify) is supported right now.
+/// Everywhere else start() fails, and callers should just rescan.
+///
+class FolderWatcher
+{
+public:
+    FolderWatcher() = default;
+    ~FolderWatcher();
+
+    FolderWatcher(const FolderWatcher&) = delete;
+    FolderWatcher& operator=(const FolderWatcher&) = delete;
+
+    struct Change {
+        // MODIFIED is for files only, once a write is done with them
+        enum Kind { ADDED, REMOVED, MODIFIED };
+        Kind kind{ ADDED };
+        bool isFolder{};
+        String relativePath{};
+    };
+
+    static bool isSupported();
+
+    bool start(const String& rootFolder, const bool recursive);
+    void stop();
+    bool isWatching() const { return handle_ >= 0; }
+    const String& getRootFolder() const { return rootFolder_; }
+
+    // collects pending changes without blocking.  returns false if the
+    // watch is no longer reliable (overflow, root gone, etc.), in which
+    // case the caller should rescan everything and start() again.
+    bool poll(std::vector<Change>& changes);
+
+private:
+    int handle_{ -1 };
+    bool recursive_{};
+    String rootFolder_{};
+    std::string nativeRoot_{};
+    std::map<int, String> watches_{};
+
+    bool watchFolder(const String& relativeFolder);
+    void unwatchFolder(const String& relativeFolder);
+};
+
+#endif /// __SRG_FOLDER_WATCHER_HEADER__
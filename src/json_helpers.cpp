@@ -8,26 +8,28 @@ void to_json(json& j, ConfigItems* settings)
     if (settings == nullptr)
         return;
 
-    auto& items = settings->getSettings_();
-    for (auto& item : items) {
+    auto& table = settings->getTable();
+    table.forEach([&](const std::string& name, const SettingsTable::slot_t slot) {
         json entry;
-        entry["name"] = item.first;
-        switch (item.second->getType()) {
-        case ConfigItem::T_BOOL:
-            entry["value"] = (static_cast<BoolConfigItem*>(item.second))->getValue();
+        entry["name"] = name;
+        switch (table.typeOf(slot)) {
+        case SettingsTable::T_BOOL:
+            entry["value"] = table.getBool(slot);
             break;
-        case ConfigItem::T_INT:
-            entry["value"] = (static_cast<IntConfigItem*>(item.second))->getValue();
+        case SettingsTable::T_INT:
+            entry["value"] = table.getInt(slot);
             break;
-        case ConfigItem::T_FLOAT:
-            entry["value"] = (static_cast<FloatConfigItem*>(item.second))->getValue();
+        case SettingsTable::T_FLOAT:
+            entry["value"] = table.getFloat(slot);
             break;
-        case ConfigItem::T_STRING:
-            entry["value"] = translate((static_cast<StringConfigItem*>(item.second))->getValue());
+        case SettingsTable::T_STRING:
+            entry["value"] = table.getString(slot);
+            break;
+        default:
             break;
         }
         j.push_back(entry);
-    }
+    });
 }
 
 void from_json(json& j, ConfigItems* settings)
@@ -58,6 +60,9 @@ void from_json(json& j, ConfigItems* settings)
             settings->add(configKey, stringValue);
         }
     }
+
+    // items scripts still hold from before follow the loaded values
+    settings->reattach();
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////
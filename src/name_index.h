@@ -0,0 +1,72 @@
+#pragma once
+#ifndef __SRG_NAME_INDEX_HEADER__
+#define __SRG_NAME_INDEX_HEADER__
+
+#include "config_table.h"
+#include <cstdint>
+#include <vector>
+
+///
+/// Maps interned names to table slots, open addressed on a hash the
+/// caller already has (StringName keeps its own), so a hit compares a
+/// hash and a pointer and never touches the text.  Name only needs to
+/// be default constructible and comparable with ==.
+///
+template<typename Name>
+class NameIndex
+{
+public:
+    SettingsTable::slot_t find(const Name& name, const uint32_t hash) const
+    {
+        if (keys_.empty())
+            return SettingsTable::npos;
+
+        auto mask = keys_.size() - 1;
+        for (auto i = hash & mask; keys_[i].slot != SettingsTable::npos; i = (i + 1) & mask) {
+            auto& key = keys_[i];
+            if (key.hash == hash && key.name == name)
+                return key.slot;
+        }
+        return SettingsTable::npos;
+    }
+
+    void remember(const Name& name, const uint32_t hash, const SettingsTable::slot_t slot)
+    {
+        // kept at most half full, so probes stay short
+        if ((count_ + 1) * 2 > keys_.size()) {
+            std::vector<Key> old;
+            old.swap(keys_);
+            keys_.resize(old.empty() ? 16 : old.size() * 2);
+            count_ = 0;
+            for (auto& key : old) {
+                if (key.slot != SettingsTable::npos)
+                    remember(key.name, key.hash, key.slot);
+            }
+        }
+
+        auto mask = keys_.size() - 1;
+        auto i = hash & mask;
+        while (keys_[i].slot != SettingsTable::npos) {
+            i = (i + 1) & mask;
+        }
+        keys_[i] = Key{ name, hash, slot };
+        count_++;
+    }
+
+    void clear()
+    {
+        keys_.clear();
+        count_ = 0;
+    }
+
+private:
+    struct Key {
+        Name name{};
+        uint32_t hash{};
+        SettingsTable::slot_t slot{ SettingsTable::npos };
+    };
+    std::vector<Key> keys_{};
+    size_t count_{};
+};
+
+#endif /// __SRG_NAME_INDEX_HEADER__
@@ -0,0 +1,121 @@
+#include "path_cache.h"
+#include <godot_cpp/classes/os.hpp>
+#include <godot_cpp/classes/dir_access.hpp>
+#include <godot_cpp/classes/file_access.hpp>
+
+std::mutex PathCache::lock_{};
+PathCache::State* PathCache::state_{ nullptr };
+std::atomic<uint64_t> PathCache::generation_{ 1 };
+
+bool PathCache::isEditor()
+{
+    static const bool editor = OS::get_singleton()->has_feature("editor");
+    return editor;
+}
+
+String PathCache::executableFolder()
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    auto& folder = state().executableFolder;
+    if (folder.is_empty())
+        folder = OS::get_singleton()->get_executable_path().get_base_dir();
+    return folder;
+}
+
+void PathCache::shutdown()
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    delete state_;
+    state_ = nullptr;
+}
+
+PathCache::State& PathCache::state()
+{
+    if (state_ == nullptr)
+        state_ = new State();
+    return *state_;
+}
+
+bool PathCache::lookup(const String& path, const uint8_t known, bool& exists)
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    auto& entries = state().entries;
+    auto it = entries.find(path);
+    if (it == entries.end() || (it->second & known) == 0)
+        return false;
+
+    // the existence bit sits right above its known bit
+    exists = (it->second & (known << 1)) != 0;
+    return true;
+}
+
+void PathCache::remember(const String& path, const uint8_t known, const uint8_t existence)
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    auto& entry = state().entries[path];
+    entry = static_cast<uint8_t>((entry & ~(known | (known << 1))) | known | existence);
+}
+
+bool PathCache::folderExists(const String& folder)
+{
+    bool exists;
+    if (lookup(folder, FOLDER_KNOWN, exists))
+        return exists;
+
+    exists = DirAccess::dir_exists_absolute(folder);
+    // folders come and go without us hearing of it, so only a hit is kept
+    if (exists)
+        remember(folder, FOLDER_KNOWN, IS_FOLDER);
+    return exists;
+}
+
+bool PathCache::fileExists(const String& filename)
+{
+    bool exists;
+    if (lookup(filename, FILE_KNOWN, exists))
+        return exists;
+
+    exists = FileAccess::file_exists(filename);
+    remember(filename, FILE_KNOWN, exists ? IS_FILE : 0);
+    return exists;
+}
+
+void PathCache::ensureFolder(const String& folder)
+{
+    if (folderExists(folder))
+        return;
+
+    if (DirAccess::make_dir_recursive_absolute(folder) == OK)
+        remember(folder, FOLDER_KNOWN, IS_FOLDER);
+}
+
+void PathCache::noteFile(const String& filename, const bool exists)
+{
+    remember(filename, FILE_KNOWN, exists ? IS_FILE : 0);
+}
+
+void PathCache::invalidate(const String& path)
+{
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        auto& entries = state().entries;
+        auto below = path.ends_with("/") ? path : path + "/";
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (it->first == path || it->first.begins_with(below))
+                it = entries.erase(it);
+            else
+                ++it;
+        }
+    }
+    generation_.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void PathCache::invalidateAll()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        if (state_ != nullptr)
+            state_->entries.clear();
+    }
+    generation_.fetch_add(1, std::memory_order_acq_rel);
+}
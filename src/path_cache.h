@@ -0,0 +1,67 @@
+#pragma once
+#ifndef __SRG_PATH_CACHE_HEADER__
+#define __SRG_PATH_CACHE_HEADER__
+
+#include "../../SrgGdHelpers/include/__templates.hpp"
+#include "common_utils.h"
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+///
+/// Process wide memory of what the file system looked like the last
+/// time we asked.  Folder and file existence get remembered, along with
+/// the couple of OS queries every path resolution needs, so repeated
+/// saves and lookups don't keep asking the same thing.  Anything that
+/// changes the disk behind our back needs an invalidate() to be seen.
+///
+class PathCache
+{
+public:
+    // these never change while the process runs
+    static bool isEditor();
+    static String executableFolder();
+
+    static bool folderExists(const String& folder);
+    static bool fileExists(const String& filename);
+    // creates the folder if it's not there, and remembers that it is now
+    static void ensureFolder(const String& folder);
+
+    // call after writing or deleting something, so the cache agrees
+    static void noteFile(const String& filename, const bool exists);
+    // forgets path and everything below it
+    static void invalidate(const String& path);
+    static void invalidateAll();
+
+    // bumped on every invalidation.  anything memoizing resolved paths
+    // compares this to know when it has to resolve again.
+    static uint64_t generation() { return generation_.load(std::memory_order_acquire); }
+
+    // drops everything that holds Godot strings.  called from the module
+    // teardown, while godot-cpp is still there to free them.
+    static void shutdown();
+
+private:
+    // what's known about the file and the folder by that name is kept
+    // apart, a miss for one says nothing about the other
+    enum Existence : uint8_t {
+        FILE_KNOWN = 1, IS_FILE = 2,
+        FOLDER_KNOWN = 4, IS_FOLDER = 8,
+    };
+    struct State
+    {
+        std::unordered_map<String, uint8_t, StringHasher> entries;
+        String executableFolder;
+    };
+
+    static std::mutex lock_;
+    // on the heap, so it's never destroyed after godot-cpp is gone
+    static State* state_;
+    static std::atomic<uint64_t> generation_;
+
+    static State& state();
+    static bool lookup(const String& path, const uint8_t known, bool& exists);
+    static void remember(const String& path, const uint8_t known, const uint8_t existence);
+};
+
+#endif /// __SRG_PATH_CACHE_HEADER__
@@ -0,0 +1,118 @@
+#include "path_filter.h"
+
+void PathFilter::clear()
+{
+    suffixes_.clear();
+    includes_.clear();
+    excludes_.clear();
+}
+
+void PathFilter::compile(const String& filterList)
+{
+    clear();
+    suffixes_.emplace_back();
+
+    Array entries = split(filterList, ",");
+    for (int i = 0; i < entries.size(); i++) {
+        String entry = String(entries[i]).strip_edges();
+        if (entry.is_empty())
+            continue;
+
+        if (entry.begins_with("!")) {
+            entry = entry.substr(1);
+            if (!entry.is_empty())
+                excludes_.push_back(entry);
+        }
+        else if (entry.find("*") >= 0 || entry.find("?") >= 0) {
+            includes_.push_back(entry);
+        }
+        else {
+            addSuffix(entry);
+        }
+    }
+}
+
+void PathFilter::addSuffix(const String& suffix)
+{
+    // walk the suffix backwards, so names can be checked from their end
+    uint32_t node = 0;
+    for (int64_t i = suffix.length() - 1; i >= 0; i--) {
+        auto ch = suffix[i];
+        uint32_t child = 0;
+        for (auto& link : suffixes_[node].next) {
+            if (link.first == ch) {
+                child = link.second;
+                break;
+            }
+        }
+        if (child == 0) {
+            child = static_cast<uint32_t>(suffixes_.size());
+            suffixes_[node].next.emplace_back(ch, child);
+            suffixes_.emplace_back();
+        }
+        node = child;
+    }
+    suffixes_[node].terminal = true;
+}
+
+bool PathFilter::matchesSuffix(const String& name) const
+{
+    if (suffixes_.size() <= 1)
+        return false;
+
+    uint32_t node = 0;
+    for (int64_t i = name.length() - 1; i >= 0; i--) {
+        auto ch = name[i];
+        uint32_t child = 0;
+        for (auto& link : suffixes_[node].next) {
+            if (link.first == ch) {
+                child = link.second;
+                break;
+            }
+        }
+        if (child == 0)
+            return false;
+        // the shortest suffix that fits is good enough
+        if (suffixes_[child].terminal)
+            return true;
+        node = child;
+    }
+    return false;
+}
+
+bool PathFilter::matchesGlob(const String& glob, const String& name, const String& relativePath)
+{
+    if (glob.find("/") >= 0)
+        return relativePath.match(glob);
+
+    return name.match(glob);
+}
+
+bool PathFilter::acceptsFile(const String& name, const String& relativePath) const
+{
+    for (auto& glob : excludes_) {
+        if (matchesGlob(glob, name, relativePath))
+            return false;
+    }
+
+    // nothing to include means include everything
+    if (!hasIncludes())
+        return true;
+
+    if (matchesSuffix(name))
+        return true;
+    for (auto& glob : includes_) {
+        if (matchesGlob(glob, name, relativePath))
+            return true;
+    }
+    return false;
+}
+
+bool PathFilter::acceptsFolder(const String& name, const String& relativePath) const
+{
+    for (auto& glob : excludes_) {
+        if (matchesGlob(glob, name, relativePath))
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#ifndef __SRG_PATH_FILTER_HEADER__
+#define __SRG_PATH_FILTER_HEADER__
+
+#include "../../SrgGdHelpers/include/__templates.hpp"
+#include <utility>
+#include <vector>
+
+///
+/// Compiled form of a comma separated filter list, like ".json,.png".
+/// Plain entries are suffixes, and get folded into a trie of reversed
+/// suffixes, so a name is checked against all of them in one pass.
+/// Entries with wildcards (* or ?) are include globs.  Entries starting
+/// with ! are exclude globs, and also stop folders from being entered.
+/// Globs with a / in them match the relative path, the rest match
+/// just the name.
+///
+class PathFilter
+{
+public:
+    PathFilter() = default;
+
+    void compile(const String& filterList);
+    void clear();
+
+    bool isEmpty() const { return !hasIncludes() && excludes_.empty(); }
+
+    bool acceptsFile(const String& name, const String& relativePath) const;
+    bool acceptsFolder(const String& name, const String& relativePath) const;
+
+private:
+    struct SuffixNode {
+        std::vector<std::pair<char32_t, uint32_t>> next{};
+        bool terminal{};
+    };
+
+    std::vector<SuffixNode> suffixes_{};
+    std::vector<String> includes_{};
+    std::vector<String> excludes_{};
+
+    bool hasIncludes() const { return suffixes_.size() > 1 || !includes_.empty(); }
+    void addSuffix(const String& suffix);
+    bool matchesSuffix(const String& name) const;
+    static bool matchesGlob(const String& glob, const String& name, const String& relativePath);
+};
+
+#endif /// __SRG_PATH_FILTER_HEADER__
@@ -0,0 +1,62 @@
+#include "path_manifest.h"
+#include "common_utils.h"
+#include <godot_cpp/classes/file_access.hpp>
+#include <cstring>
+
+namespace {
+    const uint32_t MANIFEST_MAGIC = 0x464D5253; // "SRMF"
+    const uint32_t MANIFEST_VERSION = 2;
+
+    struct ManifestHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t signatureLength;
+    };
+}
+
+bool PathManifest::write(const String& filename, const String& signature, const PathTree& items)
+{
+    std::string signatureData = translate(signature);
+
+    ManifestHeader header{ MANIFEST_MAGIC, MANIFEST_VERSION, static_cast<uint32_t>(signatureData.size()) };
+    PackedByteArray data;
+    data.resize(sizeof(header) + signatureData.size());
+    std::memcpy(data.ptrw(), &header, sizeof(header));
+    std::memcpy(data.ptrw() + sizeof(header), signatureData.data(), signatureData.size());
+    items.writeTo(data);
+
+    ensureFolderExists(filename.get_base_dir());
+    auto file = FileAccess::open(filename, FileAccess::WRITE);
+    if (file.is_null()) {
+        DEBUG("Manifest save failed.");
+        return false;
+    }
+    file->store_buffer(data);
+    file->close();
+    return true;
+}
+
+bool PathManifest::read(const String& filename, const String& signature, PathTree& items)
+{
+    if (!FileAccess::file_exists(filename))
+        return false;
+
+    auto data = FileAccess::get_file_as_bytes(filename);
+    auto size = static_cast<size_t>(data.size());
+    if (size < sizeof(ManifestHeader))
+        return false;
+
+    ManifestHeader header;
+    std::memcpy(&header, data.ptr(), sizeof(header));
+    if (header.magic != MANIFEST_MAGIC || header.version != MANIFEST_VERSION)
+        return false;
+    if (sizeof(header) + header.signatureLength > size)
+        return false;
+
+    auto stored = String::utf8(reinterpret_cast<const char*>(data.ptr() + sizeof(header)), header.signatureLength);
+    if (stored != signature)
+        return false;
+
+    auto offset = sizeof(header) + header.signatureLength;
+    return items.readFrom(data.ptr() + offset, size - offset);
+}
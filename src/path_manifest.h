@@ -0,0 +1,22 @@
+#pragma once
+#ifndef __SRG_PATH_MANIFEST_HEADER__
+#define __SRG_PATH_MANIFEST_HEADER__
+
+#include "../../SrgGdHelpers/include/__templates.hpp"
+#include "path_tree.h"
+
+///
+/// A scan result baked into a file, to ship in place of the folder walk.
+/// The file is a short header followed by the tree's flat image, so it
+/// comes in with a single read and a few block copies.  The signature
+/// describes the scan that made it; a manifest from a differently set
+/// up scanner is refused, and the caller walks the folder as usual.
+///
+class PathManifest
+{
+public:
+    static bool write(const String& filename, const String& signature, const PathTree& items);
+    static bool read(const String& filename, const String& signature, PathTree& items);
+};
+
+#endif /// __SRG_PATH_MANIFEST_HEADER__
@@ -0,0 +1,213 @@
+#include "path_preloader.h"
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/resource_loader.hpp>
+#include <godot_cpp/classes/scene_tree.hpp>
+#include <godot_cpp/classes/texture2d.hpp>
+
+namespace {
+    // anything that isn't a texture gets charged a flat amount
+    const int64_t DEFAULT_RESOURCE_COST = 4 * 1024;
+}
+
+void PathPreloader::_bind_methods()
+{
+    DECLARE_RESOURCE_PROPERTY(PathPreloader, Collection, collection, PathNamesCollection);
+    DECLARE_RESOURCE_PROPERTY(PathPreloader, Scanner, scanner, PathScannerBase);
+    DECLARE_PROPERTY(PathPreloader, MaxConcurrent, newCount, Variant::INT);
+    DECLARE_PROPERTY(PathPreloader, MemoryBudget, newBudget, Variant::INT);
+    DECLARE_PROPERTY(PathPreloader, TypeHint, newHint, Variant::STRING);
+
+    ClassDB::bind_method(D_METHOD("queueAll", "priority"), &PathPreloader::queueAll, DEFVAL(0));
+    ClassDB::bind_method(D_METHOD("request", "path", "priority"), &PathPreloader::request, DEFVAL(0));
+    ClassDB::bind_method(D_METHOD("cancelPending"), &PathPreloader::cancelPending);
+    ClassDB::bind_method(D_METHOD("getLoaded", "path"), &PathPreloader::getLoaded);
+    ClassDB::bind_method(D_METHOD("isLoaded", "path"), &PathPreloader::isLoaded);
+    ClassDB::bind_method(D_METHOD("isBusy"), &PathPreloader::isBusy);
+    ClassDB::bind_method(D_METHOD("getCachedBytes"), &PathPreloader::getCachedBytes);
+    ClassDB::bind_method(D_METHOD("getCachedCount"), &PathPreloader::getCachedCount);
+    ClassDB::bind_method(D_METHOD("clearCache"), &PathPreloader::clearCache);
+    ClassDB::bind_method(D_METHOD("_poll"), &PathPreloader::_poll);
+
+    ADD_SIGNAL(MethodInfo("item_ready", PropertyInfo(Variant::STRING, "path"), PropertyInfo(Variant::OBJECT, "resource", PROPERTY_HINT_RESOURCE_TYPE, "Resource")));
+    ADD_SIGNAL(MethodInfo("item_failed", PropertyInfo(Variant::STRING, "path")));
+    ADD_SIGNAL(MethodInfo("all_ready"));
+}
+
+void PathPreloader::setMemoryBudget(int64_t newBudget)
+{
+    memoryBudget_ = newBudget < 0 ? 0 : newBudget;
+    trimCache(String());
+}
+
+void PathPreloader::queueAll(const int64_t priority)
+{
+    Array paths;
+    if (collection_.is_valid())
+        paths = collection_->getItemsLong();
+    else if (scanner_.is_valid())
+        paths = scanner_->getItemsLong();
+
+    for (int64_t i = 0; i < paths.size(); i++) {
+        request(paths[i], priority);
+    }
+}
+
+void PathPreloader::request(const String path, const int64_t priority)
+{
+    if (path.is_empty() || cache_.count(path) > 0)
+        return;
+    for (auto& loading : inFlight_) {
+        if (loading == path)
+            return;
+    }
+
+    auto it = queued_.find(path);
+    if (it != queued_.end()) {
+        if (it->second >= priority)
+            return;
+        it->second = priority;
+    }
+    else {
+        queued_.emplace(path, priority);
+    }
+    pending_.push(QueuedItem{ priority, nextOrder_++, path });
+    startPolling();
+}
+
+void PathPreloader::cancelPending()
+{
+    pending_ = std::priority_queue<QueuedItem>();
+    queued_.clear();
+    if (inFlight_.empty())
+        stopPolling();
+}
+
+Ref<Resource> PathPreloader::getLoaded(const String path)
+{
+    auto it = cache_.find(path);
+    if (it == cache_.end())
+        return Ref<Resource>();
+
+    recency_.splice(recency_.begin(), recency_, it->second.position);
+    return it->second.resource;
+}
+
+void PathPreloader::clearCache()
+{
+    cache_.clear();
+    recency_.clear();
+    cachedBytes_ = 0;
+}
+
+void PathPreloader::startPolling()
+{
+    if (polling_)
+        return;
+
+    auto tree = Object::cast_to<SceneTree>(Engine::get_singleton()->get_main_loop());
+    if (tree == nullptr)
+        return;
+
+    tree->connect("process_frame", Callable(this, "_poll"));
+    polling_ = true;
+}
+
+void PathPreloader::stopPolling()
+{
+    if (!polling_)
+        return;
+
+    auto tree = Object::cast_to<SceneTree>(Engine::get_singleton()->get_main_loop());
+    if (tree != nullptr)
+        tree->disconnect("process_frame", Callable(this, "_poll"));
+    polling_ = false;
+}
+
+void PathPreloader::_poll()
+{
+    auto loader = ResourceLoader::get_singleton();
+
+    // collect what finished.  the loads themselves ran on loader threads,
+    // so all this does is hand the results over.
+    for (size_t i = 0; i < inFlight_.size();) {
+        auto path = inFlight_[i];
+        auto status = loader->load_threaded_get_status(path);
+        if (status == ResourceLoader::THREAD_LOAD_IN_PROGRESS) {
+            i++;
+            continue;
+        }
+
+        inFlight_.erase(inFlight_.begin() + i);
+        Ref<Resource> resource;
+        if (status == ResourceLoader::THREAD_LOAD_LOADED)
+            resource = loader->load_threaded_get(path);
+
+        if (resource.is_valid()) {
+            store(path, resource);
+            emit_signal("item_ready", path, resource);
+        }
+        else {
+            emit_signal("item_failed", path);
+        }
+    }
+
+    startLoads();
+
+    if (inFlight_.empty() && pending_.empty()) {
+        stopPolling();
+        emit_signal("all_ready");
+    }
+}
+
+void PathPreloader::startLoads()
+{
+    auto loader = ResourceLoader::get_singleton();
+    while (static_cast<int64_t>(inFlight_.size()) < maxConcurrent_ && !pending_.empty()) {
+        auto item = pending_.top();
+        pending_.pop();
+
+        // an older entry for something that got raised since, or dropped
+        auto it = queued_.find(item.path);
+        if (it == queued_.end() || it->second != item.priority)
+            continue;
+        queued_.erase(it);
+
+        if (loader->load_threaded_request(item.path, typeHint_) == OK)
+            inFlight_.push_back(item.path);
+        else
+            emit_signal("item_failed", item.path);
+    }
+}
+
+void PathPreloader::store(const String& path, Ref<Resource> resource)
+{
+    auto cost = estimateCost(resource);
+    recency_.push_front(path);
+    cache_[path] = CacheEntry{ resource, cost, recency_.begin() };
+    cachedBytes_ += cost;
+    trimCache(path);
+}
+
+void PathPreloader::trimCache(const String& keep)
+{
+    if (memoryBudget_ <= 0)
+        return;
+
+    // the newest one stays, even if it alone is over budget
+    while (cachedBytes_ > memoryBudget_ && !recency_.empty() && recency_.back() != keep) {
+        auto it = cache_.find(recency_.back());
+        cachedBytes_ -= it->second.cost;
+        cache_.erase(it);
+        recency_.pop_back();
+    }
+}
+
+int64_t PathPreloader::estimateCost(Ref<Resource> resource)
+{
+    // uncompressed rgba, which is what most portraits end up as
+    auto texture = Object::cast_to<Texture2D>(resource.ptr());
+    if (texture != nullptr)
+        return texture->get_width() * texture->get_height() * 4;
+
+    return DEFAULT_RESOURCE_COST;
+}
@@ -0,0 +1,110 @@
+#pragma once
+#ifndef __SRG_PATH_PRELOADER_HEADER__
+#define __SRG_PATH_PRELOADER_HEADER__
+
+#include "../../SrgGdHelpers/include/__templates.hpp"
+#include "common_utils.h"
+#include "files_source.h"
+#include <godot_cpp/classes/resource.hpp>
+#include <list>
+#include <queue>
+#include <unordered_map>
+
+///
+/// Loads the resources a scanner or collection lists, in the background.
+/// Requests go to ResourceLoader's threaded loading, a few at a time and
+/// most important first, and are checked on once per frame.  Every
+/// resource that comes in is announced with item_ready, and kept in a
+/// least-recently-used cache that's trimmed to the memory budget.
+///
+class PathPreloader GDX_SUBCLASS(Resource)
+{
+    GDX_CLASS_PREFIX(PathPreloader, Resource);
+
+public:
+    PathPreloader() = default;
+    virtual ~PathPreloader() = default;
+
+    // either one feeds queueAll.  the collection wins if both are set.
+    Ref<PathNamesCollection> getCollection() const { return collection_; }
+    void setCollection(Ref<PathNamesCollection> collection) { collection_ = collection; }
+    Ref<PathScannerBase> getScanner() const { return scanner_; }
+    void setScanner(Ref<PathScannerBase> scanner) { scanner_ = scanner; }
+
+    // how many loads are allowed in flight at once
+    int64_t getMaxConcurrent() const { return maxConcurrent_; }
+    void setMaxConcurrent(int64_t newCount) { maxConcurrent_ = newCount < 1 ? 1 : newCount; }
+
+    // estimated bytes the cache may hold.  0 means no limit.
+    int64_t getMemoryBudget() const { return memoryBudget_; }
+    void setMemoryBudget(int64_t newBudget);
+
+    // passed on to ResourceLoader, like "Texture2D"
+    String getTypeHint() const { return typeHint_; }
+    void setTypeHint(const String newHint) { typeHint_ = newHint; }
+
+    // queues everything the source lists, with its full path
+    void queueAll(const int64_t priority = 0);
+    // higher priority loads first.  asking again for something already
+    // queued only ever raises its priority.
+    void request(const String path, const int64_t priority = 0);
+    // drops everything not yet started.  loads in flight still finish.
+    void cancelPending();
+
+    // the cached resource, or null if it isn't loaded (yet)
+    Ref<Resource> getLoaded(const String path);
+    bool isLoaded(const String path) const { return cache_.count(path) > 0; }
+    bool isBusy() const { return !inFlight_.empty() || !pending_.empty(); }
+
+    int64_t getCachedBytes() const { return cachedBytes_; }
+    int64_t getCachedCount() const { return static_cast<int64_t>(cache_.size()); }
+    void clearCache();
+
+    void _poll();
+
+private:
+    struct QueuedItem {
+        int64_t priority{};
+        uint64_t order{};
+        String path{};
+        bool operator<(const QueuedItem& other) const {
+            // the heap puts the largest on top, so earlier wins ties
+            if (priority != other.priority)
+                return priority < other.priority;
+            return order > other.order;
+        }
+    };
+
+    struct CacheEntry {
+        Ref<Resource> resource{};
+        int64_t cost{};
+        std::list<String>::iterator position{};
+    };
+
+    Ref<PathNamesCollection> collection_{};
+    Ref<PathScannerBase> scanner_{};
+    int64_t maxConcurrent_{ 4 };
+    int64_t memoryBudget_{ 64 * 1024 * 1024 };
+    String typeHint_{};
+
+    // stale heap entries are skipped when popped, rather than searched for
+    std::priority_queue<QueuedItem> pending_{};
+    std::unordered_map<String, int64_t, StringHasher> queued_{};
+    uint64_t nextOrder_{};
+    std::vector<String> inFlight_{};
+
+    // front is the most recently used
+    std::list<String> recency_{};
+    std::unordered_map<String, CacheEntry, StringHasher> cache_{};
+    int64_t cachedBytes_{};
+    bool polling_{};
+
+    void startPolling();
+    void stopPolling();
+    void startLoads();
+    void store(const String& path, Ref<Resource> resource);
+    void trimCache(const String& keep);
+    static int64_t estimateCost(Ref<Resource> resource);
+};
+
+#endif /// __SRG_PATH_PRELOADER_HEADER__
@@ -0,0 +1,594 @@
+#include "path_tree.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    const uint32_t IMAGE_COUNTS = 4;
+    const size_t MIN_COLLECT_COUNT = 1024;
+
+    template<typename T>
+    void appendBlock(PackedByteArray& data, int64_t& offset, const T* items, const size_t count)
+    {
+        auto bytes = static_cast<int64_t>(count * sizeof(T));
+        if (bytes > 0)
+            std::memcpy(data.ptrw() + offset, items, static_cast<size_t>(bytes));
+        offset += bytes;
+    }
+
+    template<typename T>
+    bool readBlock(const uint8_t* data, const size_t size, size_t& offset, T* items, const size_t count)
+    {
+        auto bytes = count * sizeof(T);
+        if (offset + bytes > size)
+            return false;
+        if (bytes > 0)
+            std::memcpy(items, data + offset, bytes);
+        offset += bytes;
+        return true;
+    }
+
+    // calls fn for every non-empty, '/' separated component of the path
+    template<typename F>
+    bool forEachComponent(const String& path, F fn)
+    {
+        const char32_t* chars = path.ptr();
+        const int64_t length = path.length();
+        int64_t start = 0;
+        for (int64_t i = 0; i <= length; i++) {
+            if (i == length || chars[i] == U'/') {
+                if (i > start) {
+                    if (!fn(std::u32string_view(chars + start, static_cast<size_t>(i - start))))
+                        return false;
+                }
+                start = i + 1;
+            }
+        }
+        return true;
+    }
+}
+
+void PathTree::clear()
+{
+    arenaBlocks_.clear();
+    arenaUsed_ = ARENA_BLOCK_SIZE;
+    names_.clear();
+    nameIndex_.clear();
+    nodes_.clear();
+    childIndex_.clear();
+    firstChild_.clear();
+    nextSibling_.clear();
+    firstRoot_ = npos;
+    removedSinceCollect_ = 0;
+    entries_.clear();
+    sizes_.clear();
+    modifiedTimes_.clear();
+    fingerprints_.clear();
+    folders_.clear();
+    indexed_ = true;
+}
+
+void PathTree::ensureIndexed() const
+{
+    if (indexed_)
+        return;
+
+    nameIndex_.clear();
+    nameIndex_.reserve(names_.size());
+    for (size_t i = 0; i < names_.size(); i++) {
+        nameIndex_.emplace(names_[i], static_cast<index_t>(i));
+    }
+    childIndex_.clear();
+    childIndex_.reserve(nodes_.size());
+    firstChild_.assign(nodes_.size(), npos);
+    nextSibling_.assign(nodes_.size(), npos);
+    firstRoot_ = npos;
+    for (size_t i = 0; i < nodes_.size(); i++) {
+        childIndex_.emplace(childKey(nodes_[i].parent, nodes_[i].name), static_cast<index_t>(i));
+        linkChild(static_cast<index_t>(i));
+    }
+    indexed_ = true;
+}
+
+void PathTree::linkChild(const index_t node) const
+{
+    auto parent = nodes_[node].parent;
+    auto& head = parent == npos ? firstRoot_ : firstChild_[parent];
+    nextSibling_[node] = head;
+    head = node;
+}
+
+template<typename F>
+void PathTree::forEachBelow(const index_t root, F fn) const
+{
+    ensureIndexed();
+    std::vector<index_t> pending;
+    for (auto child = firstChild_[root]; child != npos; child = nextSibling_[child]) {
+        pending.push_back(child);
+    }
+    while (!pending.empty()) {
+        auto node = pending.back();
+        pending.pop_back();
+        fn(node);
+        for (auto child = firstChild_[node]; child != npos; child = nextSibling_[child]) {
+            pending.push_back(child);
+        }
+    }
+}
+
+PathTree::index_t PathTree::findName(std::u32string_view name) const
+{
+    ensureIndexed();
+    auto it = nameIndex_.find(name);
+    return it == nameIndex_.end() ? npos : it->second;
+}
+
+PathTree::index_t PathTree::internName(std::u32string_view name)
+{
+    auto existing = findName(name);
+    if (existing != npos)
+        return existing;
+
+    char32_t* storage;
+    if (name.size() > ARENA_BLOCK_SIZE / 4) {
+        // big names get a block of their own, and the next small name
+        // starts a fresh shared block
+        arenaBlocks_.push_back(std::make_unique<char32_t[]>(name.size()));
+        storage = arenaBlocks_.back().get();
+        arenaUsed_ = ARENA_BLOCK_SIZE;
+    }
+    else {
+        if (arenaUsed_ + name.size() > ARENA_BLOCK_SIZE) {
+            arenaBlocks_.push_back(std::make_unique<char32_t[]>(ARENA_BLOCK_SIZE));
+            arenaUsed_ = 0;
+        }
+        storage = arenaBlocks_.back().get() + arenaUsed_;
+        arenaUsed_ += name.size();
+    }
+    std::memcpy(storage, name.data(), name.size() * sizeof(char32_t));
+
+    auto index = static_cast<index_t>(names_.size());
+    std::u32string_view stored(storage, name.size());
+    names_.push_back(stored);
+    nameIndex_.emplace(stored, index);
+    return index;
+}
+
+PathTree::index_t PathTree::findNode(const String& relativePath) const
+{
+    ensureIndexed();
+    index_t node = npos;
+    bool found = forEachComponent(relativePath, [&](std::u32string_view component) {
+        auto name = findName(component);
+        if (name == npos)
+            return false;
+        auto it = childIndex_.find(childKey(node, name));
+        if (it == childIndex_.end())
+            return false;
+        node = it->second;
+        return true;
+    });
+    return found ? node : npos;
+}
+
+PathTree::index_t PathTree::makeNode(const String& relativePath)
+{
+    ensureIndexed();
+    index_t node = npos;
+    forEachComponent(relativePath, [&](std::u32string_view component) {
+        auto name = internName(component);
+        auto key = childKey(node, name);
+        auto it = childIndex_.find(key);
+        if (it != childIndex_.end()) {
+            node = it->second;
+        }
+        else {
+            auto child = static_cast<index_t>(nodes_.size());
+            nodes_.push_back(Node{ node, name, npos });
+            childIndex_.emplace(key, child);
+            firstChild_.push_back(npos);
+            nextSibling_.push_back(npos);
+            linkChild(child);
+            node = child;
+        }
+        return true;
+    });
+    return node;
+}
+
+PathTree::index_t PathTree::add(const String& relativePath)
+{
+    auto node = makeNode(relativePath);
+    if (node == npos)
+        return npos;
+
+    if (nodes_[node].entry == npos) {
+        nodes_[node].entry = static_cast<index_t>(entries_.size());
+        entries_.push_back(node);
+        sizes_.push_back(0);
+        modifiedTimes_.push_back(0);
+        fingerprints_.push_back(0);
+        folders_.push_back(0);
+    }
+    return nodes_[node].entry;
+}
+
+void PathTree::add(const std::vector<String>& relativePaths)
+{
+    entries_.reserve(entries_.size() + relativePaths.size());
+    for (auto& path : relativePaths) {
+        add(path);
+    }
+}
+
+PathTree::index_t PathTree::add(const String& relativePath, const uint64_t size, const uint64_t modifiedTime, const bool isFolder)
+{
+    // an existing entry takes the newer metadata
+    auto entry = add(relativePath);
+    if (entry != npos) {
+        sizes_[entry] = size;
+        modifiedTimes_[entry] = modifiedTime;
+        folders_[entry] = isFolder ? 1 : 0;
+    }
+    return entry;
+}
+
+PathTree::index_t PathTree::find(const String& relativePath) const
+{
+    auto node = findNode(relativePath);
+    return node == npos ? npos : nodes_[node].entry;
+}
+
+void PathTree::compactEntries(const std::vector<bool>& doomed)
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < entries_.size(); i++) {
+        if (doomed[i]) {
+            nodes_[entries_[i]].entry = npos;
+            continue;
+        }
+        entries_[kept] = entries_[i];
+        sizes_[kept] = sizes_[i];
+        modifiedTimes_[kept] = modifiedTimes_[i];
+        fingerprints_[kept] = fingerprints_[i];
+        folders_[kept] = folders_[i];
+        nodes_[entries_[kept]].entry = static_cast<index_t>(kept);
+        kept++;
+    }
+    removedSinceCollect_ += entries_.size() - kept;
+    entries_.resize(kept);
+    sizes_.resize(kept);
+    modifiedTimes_.resize(kept);
+    fingerprints_.resize(kept);
+    folders_.resize(kept);
+
+    if (removedSinceCollect_ > std::max(MIN_COLLECT_COUNT, entries_.size()))
+        collectGarbage();
+}
+
+void PathTree::collectGarbage()
+{
+    removedSinceCollect_ = 0;
+
+    // a node stays if an entry is at or below it
+    std::vector<uint8_t> live(nodes_.size());
+    for (auto entry : entries_) {
+        for (auto node = entry; node != npos && !live[node]; node = nodes_[node].parent) {
+            live[node] = 1;
+        }
+    }
+
+    // the old names stay readable until everything's copied over
+    auto oldBlocks = std::move(arenaBlocks_);
+    auto oldNames = std::move(names_);
+    arenaBlocks_.clear();
+    arenaUsed_ = ARENA_BLOCK_SIZE;
+    names_.clear();
+    nameIndex_.clear();
+    childIndex_.clear();
+    indexed_ = true;
+
+    // parents always come before their children, and keeping the order
+    // keeps it that way
+    std::vector<index_t> nodeMap(nodes_.size(), npos);
+    std::vector<index_t> nameMap(oldNames.size(), npos);
+    size_t kept = 0;
+    for (size_t i = 0; i < nodes_.size(); i++) {
+        if (!live[i])
+            continue;
+        auto node = nodes_[i];
+        if (nameMap[node.name] == npos)
+            nameMap[node.name] = internName(oldNames[node.name]);
+        node.name = nameMap[node.name];
+        node.parent = node.parent == npos ? npos : nodeMap[node.parent];
+        nodeMap[i] = static_cast<index_t>(kept);
+        nodes_[kept++] = node;
+    }
+    nodes_.resize(kept);
+    for (auto& entry : entries_) {
+        entry = nodeMap[entry];
+    }
+
+    // lookups and child links get rebuilt on next use
+    indexed_ = false;
+}
+
+size_t PathTree::removeBranch(const String& relativeFolder)
+{
+    auto target = findNode(relativeFolder);
+    if (target == npos)
+        return entries_.size();
+
+    // a walk lists a branch in one run, so this is usually one block
+    std::vector<bool> doomed(entries_.size());
+    size_t first = entries_.size();
+    auto doom = [&](const index_t node) {
+        auto entry = nodes_[node].entry;
+        if (entry == npos)
+            return;
+        doomed[entry] = true;
+        first = std::min(first, static_cast<size_t>(entry));
+    };
+    doom(target);
+    forEachBelow(target, doom);
+    if (first == entries_.size())
+        return first;
+
+    compactEntries(doomed);
+    return first;
+}
+
+size_t PathTree::insertionPoint(const String& relativeFolder) const
+{
+    auto parentPath = relativeFolder.get_base_dir();
+    auto name = relativeFolder.get_file();
+    std::u32string_view nameView(name.ptr(), static_cast<size_t>(name.length()));
+    index_t parent = npos;
+    if (!parentPath.is_empty()) {
+        parent = findNode(parentPath);
+        // the parent is new too, so it all goes where the parent would
+        if (parent == npos)
+            return insertionPoint(parentPath);
+    }
+
+    // a walk lists a folder's own files, then its subfolders by name.
+    // each sibling's branch is measured on its own, so this only looks
+    // at what's under the parent, whatever order the entries are in
+    ensureIndexed();
+    const size_t none = ~size_t(0);
+    size_t firstAfter = none, lastUnder = none;
+    for (auto child = parent == npos ? firstRoot_ : firstChild_[parent]; child != npos; child = nextSibling_[child]) {
+        size_t low = none, high = 0;
+        auto measure = [&](const index_t node) {
+            auto entry = nodes_[node].entry;
+            if (entry == npos)
+                return;
+            low = std::min(low, static_cast<size_t>(entry));
+            high = std::max(high, static_cast<size_t>(entry));
+        };
+        measure(child);
+        forEachBelow(child, measure);
+        if (low == none)
+            continue;
+
+        lastUnder = lastUnder == none ? high : std::max(lastUnder, high);
+        auto own = nodes_[child].entry;
+        auto isFolder = firstChild_[child] != npos || (own != npos && folders_[own] != 0);
+        if (isFolder && names_[nodes_[child].name] > nameView)
+            firstAfter = std::min(firstAfter, low);
+    }
+    if (firstAfter != none)
+        return firstAfter;
+    if (lastUnder != none)
+        return lastUnder + 1;
+    if (parent == npos)
+        return entries_.size();
+    if (nodes_[parent].entry != npos)
+        return nodes_[parent].entry + 1;
+    return insertionPoint(parentPath);
+}
+
+void PathTree::moveTail(const size_t first, const size_t position)
+{
+    if (position >= first || first >= entries_.size())
+        return;
+
+    std::rotate(entries_.begin() + position, entries_.begin() + first, entries_.end());
+    std::rotate(sizes_.begin() + position, sizes_.begin() + first, sizes_.end());
+    std::rotate(modifiedTimes_.begin() + position, modifiedTimes_.begin() + first, modifiedTimes_.end());
+    std::rotate(fingerprints_.begin() + position, fingerprints_.begin() + first, fingerprints_.end());
+    std::rotate(folders_.begin() + position, folders_.begin() + first, folders_.end());
+    for (size_t i = position; i < entries_.size(); i++) {
+        nodes_[entries_[i]].entry = static_cast<index_t>(i);
+    }
+}
+
+void PathTree::remove(const String& relativePath, const bool withChildren)
+{
+    remove(std::vector<String>{ relativePath }, withChildren);
+}
+
+void PathTree::remove(const std::vector<String>& relativePaths, const bool withChildren)
+{
+    std::vector<index_t> targets;
+    for (auto& path : relativePaths) {
+        auto target = findNode(path);
+        if (target != npos && (withChildren || nodes_[target].entry != npos))
+            targets.push_back(target);
+    }
+    if (targets.empty())
+        return;
+
+    // only the branches being removed get visited, then one compaction
+    // for the whole batch
+    std::vector<bool> doomed(entries_.size());
+    auto doom = [&](const index_t node) {
+        if (nodes_[node].entry != npos)
+            doomed[nodes_[node].entry] = true;
+    };
+    for (auto target : targets) {
+        doom(target);
+        if (withChildren)
+            forEachBelow(target, doom);
+    }
+    compactEntries(doomed);
+}
+
+String PathTree::pathAt(const size_t index, const String& prefix) const
+{
+    if (index >= entries_.size())
+        return String();
+
+    // gather the names leaf first, then lay them out root first
+    std::vector<index_t> chain;
+    chain.reserve(16);
+    for (auto node = entries_[index]; node != npos; node = nodes_[node].parent) {
+        chain.push_back(node);
+    }
+
+    std::u32string result;
+    if (!prefix.is_empty())
+        result.assign(prefix.ptr(), static_cast<size_t>(prefix.length()));
+    bool needSeparator = !result.empty() && result.back() != U'/';
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+        auto node = *it;
+        if (needSeparator)
+            result.push_back(U'/');
+        result.append(names_[nodes_[node].name]);
+        needSeparator = true;
+    }
+    return String(result.c_str());
+}
+
+void PathTree::collectUnder(const String& relativeFolder, std::vector<index_t>& indices) const
+{
+    auto target = findNode(relativeFolder);
+    if (target == npos)
+        return;
+
+    // just the branch, then put it in entry order
+    auto first = indices.size();
+    forEachBelow(target, [&](const index_t node) {
+        if (nodes_[node].entry != npos)
+            indices.push_back(nodes_[node].entry);
+    });
+    std::sort(indices.begin() + first, indices.end());
+}
+
+void PathTree::writeTo(PackedByteArray& data) const
+{
+    // every name back to back, so they come back as one arena block
+    std::vector<uint32_t> nameLengths;
+    nameLengths.reserve(names_.size());
+    size_t charCount = 0;
+    for (auto& name : names_) {
+        nameLengths.push_back(static_cast<uint32_t>(name.size()));
+        charCount += name.size();
+    }
+
+    uint32_t counts[IMAGE_COUNTS] = {
+        static_cast<uint32_t>(charCount),
+        static_cast<uint32_t>(names_.size()),
+        static_cast<uint32_t>(nodes_.size()),
+        static_cast<uint32_t>(entries_.size())
+    };
+    auto total = sizeof(counts) + charCount * sizeof(char32_t) + names_.size() * sizeof(uint32_t)
+        + nodes_.size() * sizeof(Node) + entries_.size() * (sizeof(index_t) + 3 * sizeof(uint64_t) + sizeof(uint8_t));
+
+    int64_t offset = data.size();
+    data.resize(offset + static_cast<int64_t>(total));
+    appendBlock(data, offset, counts, IMAGE_COUNTS);
+    for (auto& name : names_) {
+        appendBlock(data, offset, name.data(), name.size());
+    }
+    appendBlock(data, offset, nameLengths.data(), nameLengths.size());
+    appendBlock(data, offset, nodes_.data(), nodes_.size());
+    appendBlock(data, offset, entries_.data(), entries_.size());
+    appendBlock(data, offset, sizes_.data(), sizes_.size());
+    appendBlock(data, offset, modifiedTimes_.data(), modifiedTimes_.size());
+    appendBlock(data, offset, fingerprints_.data(), fingerprints_.size());
+    appendBlock(data, offset, folders_.data(), folders_.size());
+}
+
+bool PathTree::linksValid() const
+{
+    // every index has to point at something that exists, parents come
+    // before their children, and entries and nodes agree on each other
+    for (size_t i = 0; i < nodes_.size(); i++) {
+        auto& node = nodes_[i];
+        if (node.name >= names_.size())
+            return false;
+        if (node.parent != npos && node.parent >= i)
+            return false;
+        if (node.entry != npos && (node.entry >= entries_.size() || entries_[node.entry] != i))
+            return false;
+    }
+    for (size_t i = 0; i < entries_.size(); i++) {
+        if (entries_[i] >= nodes_.size() || nodes_[entries_[i]].entry != i)
+            return false;
+    }
+    return true;
+}
+
+bool PathTree::readFrom(const uint8_t* data, const size_t size)
+{
+    clear();
+
+    size_t offset = 0;
+    uint32_t counts[IMAGE_COUNTS];
+    if (!readBlock(data, size, offset, counts, IMAGE_COUNTS))
+        return false;
+
+    auto charCount = counts[0];
+    auto nameCount = counts[1];
+    auto nodeCount = counts[2];
+    auto entryCount = counts[3];
+
+    // the counts come off the disk too, don't allocate what can't be there
+    uint64_t needed = uint64_t(charCount) * sizeof(char32_t) + uint64_t(nameCount) * sizeof(uint32_t)
+        + uint64_t(nodeCount) * sizeof(Node)
+        + uint64_t(entryCount) * (sizeof(index_t) + 3 * sizeof(uint64_t) + sizeof(uint8_t));
+    if (needed > size - offset)
+        return false;
+
+    auto chars = std::make_unique<char32_t[]>(charCount > 0 ? charCount : 1);
+    std::vector<uint32_t> nameLengths(nameCount);
+    nodes_.resize(nodeCount);
+    entries_.resize(entryCount);
+    sizes_.resize(entryCount);
+    modifiedTimes_.resize(entryCount);
+    fingerprints_.resize(entryCount);
+    folders_.resize(entryCount);
+
+    bool complete = readBlock(data, size, offset, chars.get(), charCount)
+        && readBlock(data, size, offset, nameLengths.data(), nameCount)
+        && readBlock(data, size, offset, nodes_.data(), nodeCount)
+        && readBlock(data, size, offset, entries_.data(), entryCount)
+        && readBlock(data, size, offset, sizes_.data(), entryCount)
+        && readBlock(data, size, offset, modifiedTimes_.data(), entryCount)
+        && readBlock(data, size, offset, fingerprints_.data(), entryCount)
+        && readBlock(data, size, offset, folders_.data(), entryCount);
+    if (!complete) {
+        clear();
+        return false;
+    }
+
+    size_t start = 0;
+    names_.reserve(nameCount);
+    for (auto length : nameLengths) {
+        if (start + length > charCount) {
+            clear();
+            return false;
+        }
+        names_.emplace_back(chars.get() + start, length);
+        start += length;
+    }
+    if (!linksValid()) {
+        clear();
+        return false;
+    }
+    arenaBlocks_.push_back(std::move(chars));
+    // the loaded block is full, new names start one of their own
+    arenaUsed_ = ARENA_BLOCK_SIZE;
+    indexed_ = false;
+    return true;
+}
@@ -0,0 +1,130 @@
+#pragma once
+#ifndef __SRG_PATH_TREE_HEADER__
+#define __SRG_PATH_TREE_HEADER__
+
+#include "../../SrgGdHelpers/include/__templates.hpp"
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+///
+/// Compact storage for a list of relative paths.  Every path component
+/// is stored once in a string arena, and every distinct path is just a
+/// node pointing at its parent and its name.  A deep tree then costs a
+/// few bytes per entry instead of a full copy of every prefix, and
+/// full paths only get built when somebody asks for one.
+/// Sizes, times and kinds sit in columns of their own next to the
+/// entries, so sorting or filtering on one of them reads just that.
+///
+class PathTree
+{
+public:
+    using index_t = uint32_t;
+    static constexpr index_t npos = ~index_t(0);
+
+    PathTree() = default;
+
+    void clear();
+    size_t size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+
+    // adds the path as an entry, and returns its entry index.  adding a
+    // path that's already in there just returns the existing index.
+    index_t add(const String& relativePath);
+    void add(const std::vector<String>& relativePaths);
+    // same as the above, and sets the entry's metadata while at it
+    index_t add(const String& relativePath, const uint64_t size, const uint64_t modifiedTime, const bool isFolder);
+
+    index_t find(const String& relativePath) const;
+    bool contains(const String& relativePath) const { return find(relativePath) != npos; }
+
+    // removes the entry, and optionally every entry below it
+    void remove(const String& relativePath, const bool withChildren);
+    // same, for a batch of paths at once, with the list compacted once
+    void remove(const std::vector<String>& relativePaths, const bool withChildren);
+    // removes a whole branch, the folder's own entry included, and returns
+    // where the first of them was.  size() if there were none.
+    size_t removeBranch(const String& relativeFolder);
+    // where the entries of a branch that has none in the tree would go,
+    // so the list still reads in walk order: after the parent's own files
+    // and the folders that sort before it, ahead of the ones after it
+    size_t insertionPoint(const String& relativeFolder) const;
+    // moves the entries from first onward to sit at position instead.
+    // add, then this, splices a freshly scanned branch back in place.
+    void moveTail(const size_t first, const size_t position);
+
+    // rebuilds the full path, with prefix joined in front if given
+    String pathAt(const size_t index, const String& prefix = String()) const;
+    // entry indices of everything below relativeFolder, in entry order
+    void collectUnder(const String& relativeFolder, std::vector<index_t>& indices) const;
+
+    // the metadata columns, by entry index.  zero where none was given.
+    uint64_t sizeAt(const size_t index) const { return index < sizes_.size() ? sizes_[index] : 0; }
+    uint64_t modifiedTimeAt(const size_t index) const { return index < modifiedTimes_.size() ? modifiedTimes_[index] : 0; }
+    bool isFolderAt(const size_t index) const { return index < folders_.size() && folders_[index] != 0; }
+    uint64_t fingerprintAt(const size_t index) const { return index < fingerprints_.size() ? fingerprints_[index] : 0; }
+    void setFingerprint(const size_t index, const uint64_t fingerprint) { fingerprints_[index] = fingerprint; }
+    const std::vector<uint64_t>& sizes() const { return sizes_; }
+    const std::vector<uint64_t>& modifiedTimes() const { return modifiedTimes_; }
+    const std::vector<uint64_t>& fingerprints() const { return fingerprints_; }
+
+    // flat, native endian image of the whole tree.  reading one back is
+    // a handful of block copies.  the lookup tables get rebuilt the first
+    // time something needs them, so trees only ever read stay cheap.
+    void writeTo(PackedByteArray& data) const;
+    bool readFrom(const uint8_t* data, const size_t size);
+
+private:
+    struct Node {
+        index_t parent{ npos };
+        index_t name{ npos };
+        index_t entry{ npos };
+    };
+
+    static constexpr size_t ARENA_BLOCK_SIZE = 64 * 1024;
+
+    // blocks never move once allocated, so views into them stay valid
+    std::vector<std::unique_ptr<char32_t[]>> arenaBlocks_{};
+    size_t arenaUsed_{ ARENA_BLOCK_SIZE };
+    std::vector<std::u32string_view> names_{};
+    mutable std::unordered_map<std::u32string_view, index_t> nameIndex_{};
+
+    std::vector<Node> nodes_{};
+    mutable std::unordered_map<uint64_t, index_t> childIndex_{};
+    // children as linked lists, so a branch can be walked on its own
+    mutable std::vector<index_t> firstChild_{};
+    mutable std::vector<index_t> nextSibling_{};
+    mutable index_t firstRoot_{ npos };
+    mutable bool indexed_{ true };
+    // entries dropped since nodes and names were last tidied up
+    size_t removedSinceCollect_{};
+    std::vector<index_t> entries_{};
+    std::vector<uint64_t> sizes_{};
+    std::vector<uint64_t> modifiedTimes_{};
+    std::vector<uint64_t> fingerprints_{};
+    std::vector<uint8_t> folders_{};
+
+    index_t internName(std::u32string_view name);
+    index_t findName(std::u32string_view name) const;
+    index_t findNode(const String& relativePath) const;
+    index_t makeNode(const String& relativePath);
+    void linkChild(const index_t node) const;
+    // calls fn on every node below root, not root itself, in no order
+    template<typename F>
+    void forEachBelow(const index_t root, F fn) const;
+    // drops the entries flagged in doomed, keeping the columns in step
+    void compactEntries(const std::vector<bool>& doomed);
+    // drops the nodes and names no entry uses anymore, once enough of
+    // them have piled up, so a long watched tree doesn't keep growing
+    void collectGarbage();
+    void ensureIndexed() const;
+    // checks a freshly read image points only at what it has
+    bool linksValid() const;
+
+    static uint64_t childKey(const index_t parent, const index_t name) {
+        return (static_cast<uint64_t>(parent) << 32) | name;
+    }
+};
+
+#endif /// __SRG_PATH_TREE_HEADER__
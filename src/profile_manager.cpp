@@ -1,5 +1,6 @@
 #include "profile_manager.h"
 #include "cguid.h"
+#include "path_cache.h"
 #include <godot_cpp/classes/file_access.hpp>
 #include <godot_cpp/classes/dir_access.hpp>
 #include "../../SrgGdHelpers/include/nlohmann/json.hpp"
@@ -156,6 +157,7 @@ void ProfileManager::deleteProfile(const int64_t index)
     auto files = profileSource_->getItemsLong();
     auto& filename = files[index];
     DirAccess::remove_absolute(filename);
+    PathCache::noteFile(filename, false);
 
     memdelete(profile);
 
@@ -216,5 +218,6 @@ void ProfileManager::saveProfile(PlayerProfile* profile)
     auto file = FileAccess::open(filename, FileAccess::WRITE);
     file->store_line(data);
     file->close();
+    PathCache::noteFile(filename, true);
 }
 
@@ -3,9 +3,11 @@
 #include "config_settings.h"
 #include "player_profile.h"
 #include "files_source.h"
+#include "path_preloader.h"
 #include "config_store.h"
 #include "profile_manager.h"
 #include "runtime_environment.h"
+#include "path_cache.h"
 
 #include <gdextension_interface.h>
 #include <godot_cpp/core/class_db.hpp>
@@ -21,9 +23,11 @@ void initialize_utility_objects_module(ModuleInitializationLevel p_level)
     ClassDB::register_class<DynamicPathResolver>();
     ClassDB::register_class<FileLocator>();
     ClassDB::register_class<PathScannerBase>();
+    ClassDB::register_class<PathCursor>();
     ClassDB::register_class<DirectoryList>();
     ClassDB::register_class<FileList>();
     ClassDB::register_class<PathNamesCollection>();
+    ClassDB::register_class<PathPreloader>();
 
     ClassDB::register_abstract_class<ConfigItem>();
     ClassDB::register_class<BoolConfigItem>();
@@ -43,6 +47,8 @@ void uninitialize_utility_objects_module(ModuleInitializationLevel p_level)
 {
     if (p_level != MODULE_INITIALIZATION_LEVEL_SCENE)
         return;
+
+    PathCache::shutdown();
 }
 
 using namespace godot;
@@ -6,22 +6,29 @@ void RuntimeEnvironment::_bind_methods()
     DECLARE_RESOURCE_PROPERTY(RuntimeEnvironment, Profiles, profileManager, ProfileManager);
     DECLARE_RESOURCE_PROPERTY(RuntimeEnvironment, Portraits, portraits, PathNamesCollection);
     DECLARE_RESOURCE_PROPERTY(RuntimeEnvironment, DefaultPortraitFile, portraitFile, FileLocator);
+    DECLARE_RESOURCE_PROPERTY(RuntimeEnvironment, PortraitLoader, portraitLoader, PathPreloader);
 
     ClassDB::bind_method(D_METHOD("initialize"), &RuntimeEnvironment::initialize);
     ClassDB::bind_method(D_METHOD("onProfileChanged", "profile"), &RuntimeEnvironment::onProfileChanged);
     ClassDB::bind_method(D_METHOD("onSettingApplied", "settingName", "setting"), &RuntimeEnvironment::onSettingApplied);
+    ClassDB::bind_method(D_METHOD("onSettingsApplied", "names", "values"), &RuntimeEnvironment::onSettingsApplied);
 
     ADD_SIGNAL(MethodInfo("active_profile_changed", PropertyInfo(Variant::OBJECT, "profile", PROPERTY_HINT_OBJECT_ID, "PlayerProfile")));
     ADD_SIGNAL(MethodInfo("apply_setting", PropertyInfo(Variant::STRING, "setting_name"), PropertyInfo(Variant::OBJECT, "setting", PROPERTY_HINT_OBJECT_ID, "ConfigItem")));
+    ADD_SIGNAL(MethodInfo("settings_applied", PropertyInfo(Variant::PACKED_STRING_ARRAY, "names"), PropertyInfo(Variant::ARRAY, "values")));
 }
 
 void RuntimeEnvironment::initialize()
 {
     configuration_->connect("apply_setting", Callable(this, "onSettingApplied"));
+    configuration_->connect("settings_applied", Callable(this, "onSettingsApplied"));
     profiles_->connect("active_profile_changed", Callable(this, "onProfileChanged"));
     //
     configuration_->load();
     profiles_->loadProfiles();
+
+    if (portraitLoader_.is_valid() && portraitLoader_->getCollection().is_null() && portraitLoader_->getScanner().is_null())
+        portraitLoader_->setCollection(portraits_);
 }
 
 void RuntimeEnvironment::onProfileChanged(PlayerProfile* profile)
@@ -39,4 +46,9 @@ void RuntimeEnvironment::onProfileChanged(PlayerProfile* profile)
 void RuntimeEnvironment::onSettingApplied(String settingName, ConfigItem* setting)
 {
     emit_signal("apply_setting", settingName, setting);
-}
\ No newline at end of file
+}
+
+void RuntimeEnvironment::onSettingsApplied(PackedStringArray names, Array values)
+{
+    emit_signal("settings_applied", names, values);
+}
@@ -4,6 +4,7 @@
 
 #include "config_store.h"
 #include "profile_manager.h"
+#include "path_preloader.h"
 
 /// 
 /// Should serve as a wrapper for useful things a program needs.
@@ -32,18 +33,25 @@ public:
     Ref<FileLocator> getDefaultPortraitFile() { return defaultPortraitFile_; }
     void setDefaultPortraitFile(Ref<FileLocator> portraitFile) { defaultPortraitFile_ = portraitFile; }
 
+    // optional.  loads the portraits in the background, and is fed from
+    // Portraits if it has no source of its own.
+    Ref<PathPreloader> getPortraitLoader() { return portraitLoader_; }
+    void setPortraitLoader(Ref<PathPreloader> portraitLoader) { portraitLoader_ = portraitLoader; }
+
     // this is required for proper functioning 
     void initialize();
 
 protected:
     void onProfileChanged(PlayerProfile* profile);
     void onSettingApplied(String settingName, ConfigItem* setting);
+    void onSettingsApplied(PackedStringArray names, Array values);
 
 private:
     Ref<ConfigStore> configuration_{};
     Ref<ProfileManager> profiles_{};
     Ref<PathNamesCollection> portraits_{};
     Ref<FileLocator> defaultPortraitFile_{};
+    Ref<PathPreloader> portraitLoader_{};
 };
 
 #endif /// __SRG_ENVIRONMENT_WRAPPER_HEADER__
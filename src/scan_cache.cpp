@@ -0,0 +1,147 @@
+#include "scan_cache.h"
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/time.hpp>
+
+namespace {
+    // no godot types out here, they'd get built before godot-cpp is set up
+    constexpr const char* CACHE_FOLDER = "user://scan_cache";
+    const uint32_t CACHE_MAGIC = 0x43535253; // "SRSC"
+    const uint32_t CACHE_VERSION = 1;
+
+    void storeNames(Ref<FileAccess> file, const std::vector<String>& names)
+    {
+        file->store_32(static_cast<uint32_t>(names.size()));
+        for (auto& name : names) {
+            file->store_pascal_string(name);
+        }
+    }
+
+    void loadNames(Ref<FileAccess> file, std::vector<String>& names)
+    {
+        auto count = file->get_32();
+        names.reserve(count);
+        for (uint32_t i = 0; i < count && !file->eof_reached(); i++) {
+            names.push_back(file->get_pascal_string());
+        }
+    }
+}
+
+void ScanCache::open(const String& signature)
+{
+    if (isOpen() && signature_ == signature)
+        return;
+
+    signature_ = signature;
+    filename_ = String(CACHE_FOLDER).path_join(signature.md5_text() + ".cache");
+    load();
+}
+
+void ScanCache::beginScan()
+{
+    fresh_.clear();
+    dirty_ = false;
+    nextScanTime_ = static_cast<uint64_t>(Time::get_singleton()->get_unix_time_from_system());
+}
+
+void ScanCache::endScan()
+{
+    // every folder seen was stored, so if nothing new turned up, a
+    // difference in count means some folders went away
+    if (fresh_.size() != entries_.size())
+        dirty_ = true;
+
+    entries_.swap(fresh_);
+    fresh_.clear();
+    scanTime_ = nextScanTime_;
+    if (dirty_)
+        save();
+    dirty_ = false;
+}
+
+bool ScanCache::lookup(const String& relativeFolder, const uint64_t modifiedTime, FolderWalker::Listing& listing)
+{
+    // entries_ isn't touched during a scan, so no lock needed here
+    auto it = entries_.find(relativeFolder);
+    if (it == entries_.end() || it->second.modifiedTime != modifiedTime)
+        return false;
+
+    // times only have a resolution of a second.  anything touched in the
+    // same second as the last scan might have changed after we looked.
+    if (modifiedTime >= scanTime_)
+        return false;
+
+    listing = it->second.listing;
+    store(relativeFolder, modifiedTime, listing);
+    return true;
+}
+
+void ScanCache::store(const String& relativeFolder, const uint64_t modifiedTime, const FolderWalker::Listing& listing)
+{
+    // entries_ holds what's on disk.  an entry that was too recent to
+    // trust counts as changed, so the newer scan time gets written out.
+    auto it = entries_.find(relativeFolder);
+    bool changed = it == entries_.end() || it->second.modifiedTime != modifiedTime
+        || it->second.modifiedTime >= scanTime_
+        || it->second.listing.files != listing.files || it->second.listing.folders != listing.folders;
+
+    std::lock_guard<std::mutex> guard(lock_);
+    if (changed)
+        dirty_ = true;
+    auto& entry = fresh_[relativeFolder];
+    entry.modifiedTime = modifiedTime;
+    entry.listing = listing;
+}
+
+void ScanCache::load()
+{
+    entries_.clear();
+    scanTime_ = 0;
+
+    if (!FileAccess::file_exists(filename_))
+        return;
+
+    auto file = FileAccess::open(filename_, FileAccess::READ);
+    if (file.is_null())
+        return;
+
+    // a cache from some other version, or a hash collision, is just ignored
+    if (file->get_32() != CACHE_MAGIC || file->get_32() != CACHE_VERSION)
+        return;
+    if (file->get_pascal_string() != signature_)
+        return;
+
+    scanTime_ = file->get_64();
+    auto count = file->get_32();
+    for (uint32_t i = 0; i < count && !file->eof_reached(); i++) {
+        auto relativeFolder = file->get_pascal_string();
+        auto& entry = entries_[relativeFolder];
+        entry.modifiedTime = file->get_64();
+        loadNames(file, entry.listing.files);
+        loadNames(file, entry.listing.folders);
+    }
+    file->close();
+}
+
+void ScanCache::save()
+{
+    ensureFolderExists(String(CACHE_FOLDER));
+
+    auto file = FileAccess::open(filename_, FileAccess::WRITE);
+    if (file.is_null()) {
+        DEBUG("Scan cache save failed.");
+        return;
+    }
+
+    file->store_32(CACHE_MAGIC);
+    file->store_32(CACHE_VERSION);
+    file->store_pascal_string(signature_);
+    file->store_64(scanTime_);
+    file->store_32(static_cast<uint32_t>(entries_.size()));
+    for (auto& item : entries_) {
+        file->store_pascal_string(item.first);
+        file->store_64(item.second.modifiedTime);
+        storeNames(file, item.second.listing.files);
+        storeNames(file, item.second.listing.folders);
+    }
+    file->close();
+}
@@ -0,0 +1,57 @@
+#pragma once
+#ifndef __SRG_SCAN_CACHE_HEADER__
+#define __SRG_SCAN_CACHE_HEADER__
+
+#include "../../SrgGdHelpers/include/__templates.hpp"
+#include "common_utils.h"
+#include "folder_walker.h"
+#include <mutex>
+#include <unordered_map>
+
+///
+/// Remembers what every folder of a scan contained, along with its
+/// modified time, and keeps it on disk between runs.  A folder whose
+/// time hasn't moved since the last scan doesn't need to be listed
+/// again, so a rescan costs one stat per folder instead of a full walk.
+///
+class ScanCache
+{
+public:
+    ScanCache() = default;
+    ~ScanCache() = default;
+
+    // signature identifies the scan (folder, kind of listing, etc.).
+    // loads the matching cache file, if it isn't loaded already.
+    void open(const String& signature);
+    bool isOpen() const { return !filename_.is_empty(); }
+
+    void beginScan();
+    // throws away folders that weren't seen, and writes the rest out
+    // if anything differs from what's on disk
+    void endScan();
+
+    // these may be called from worker threads, between begin and end
+    bool lookup(const String& relativeFolder, const uint64_t modifiedTime, FolderWalker::Listing& listing);
+    void store(const String& relativeFolder, const uint64_t modifiedTime, const FolderWalker::Listing& listing);
+
+private:
+    struct Entry {
+        uint64_t modifiedTime{};
+        FolderWalker::Listing listing{};
+    };
+    using entries_t = std::unordered_map<String, Entry, StringHasher>;
+
+    String signature_{};
+    String filename_{};
+    uint64_t scanTime_{};
+    uint64_t nextScanTime_{};
+    entries_t entries_{};
+    entries_t fresh_{};
+    bool dirty_{};
+    std::mutex lock_{};
+
+    void load();
+    void save();
+};
+
+#endif /// __SRG_SCAN_CACHE_HEADER__